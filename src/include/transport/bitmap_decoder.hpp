@@ -0,0 +1,32 @@
+/*
+bitmap_decoder.hpp
+
+  Kernels for Redis bitmaps: strings written with SETBIT/BITFIELD. Redis
+  numbers bits from the most significant bit of the first byte, so bit n is
+  (byte[n / 8] >> (7 - n % 8)) & 1.
+    - Bytes are processed a 64-bit word at a time. On x86-64 the kernels are
+      also compiled for AVX2/BMI/POPCNT, and that build is used when the CPU
+      supports it.
+*/
+#pragma once
+#include <cstddef>
+#include <cstdint>
+
+// DecodeSetBits() writes up to this many entries past the offsets it returns.
+constexpr size_t BITMAP_DECODE_SLACK = 64;
+
+/*
+Writes the offsets of the set bits in data[0, len) to out; first_bit is the offset of the first bit of data[0].
+  - Decodes whole 8 byte words and stops before out (capacity entries) could overflow, so capacity must be
+    at least BITMAP_DECODE_SLACK. 'consumed' is set to the number of bytes decoded.
+  - Returns the number of offsets written, in ascending order.
+*/
+size_t DecodeSetBits(const char* data, size_t len, int64_t first_bit, int64_t* out, size_t capacity,
+                     size_t& consumed);
+
+// Number of set bits, as BITCOUNT.
+uint64_t CountSetBits(const char* data, size_t len);
+
+// acc[i] &= other[i] / acc[i] |= other[i] for i < len (BITOP AND / OR of two equally long strings).
+void AndBitmaps(char* acc, const char* other, size_t len);
+void OrBitmaps(char* acc, const char* other, size_t len);
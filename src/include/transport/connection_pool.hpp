@@ -0,0 +1,61 @@
+/*
+connection_pool.hpp
+
+  Idle connections to one endpoint, so queries do not pay for a TCP handshake
+  and PING every time they need a socket.
+*/
+#pragma once
+#include "transport/redis_client.hpp"
+#include "transport/redis_endpoint.hpp"
+
+#include <memory>
+#include <mutex>
+#include <vector>
+
+class ConnectionPool {
+public:
+  explicit ConnectionPool(RedisEndpoint endpoint);
+
+  const RedisEndpoint& Endpoint() const { return endpoint; }
+
+  /*
+  Returns a connected client: an idle one if available, otherwise a new connection.
+    - Throws std::runtime_error if the endpoint cannot be reached.
+  */
+  std::unique_ptr<RedisClient> Acquire();
+
+  // Hands a client back. Broken clients and clients with unread replies are closed instead.
+  void Release(std::unique_ptr<RedisClient> client);
+
+private:
+  RedisEndpoint endpoint;
+  // Idle connections kept per endpoint; more are closed on release.
+  size_t max_idle = 16;
+  std::mutex lock;
+  std::vector<std::unique_ptr<RedisClient>> idle;
+};
+
+/*
+  A client borrowed from a pool for the lifetime of this object.
+  The pool is shared so a lease stays valid when the endpoint set is reconfigured.
+*/
+class PooledClient {
+public:
+  explicit PooledClient(std::shared_ptr<ConnectionPool> pool_p)
+      : pool(std::move(pool_p)), client(pool->Acquire()) {}
+  ~PooledClient() {
+    if (client) {
+      pool->Release(std::move(client));
+    }
+  }
+
+  PooledClient(const PooledClient&) = delete;
+  PooledClient& operator=(const PooledClient&) = delete;
+
+  RedisClient& operator*() { return *client; }
+  RedisClient* operator->() { return client.get(); }
+
+private:
+  std::shared_ptr<ConnectionPool> pool;
+  std::unique_ptr<RedisClient> client;
+};
@@ -0,0 +1,35 @@
+/*
+keyspace_listener.hpp
+
+  Dedicated pub/sub connection that reports which keys matching a pattern were
+  written, deleted or expired (Redis keyspace notifications).
+*/
+#pragma once
+#include "transport/redis_client.hpp"
+#include "transport/redis_endpoint.hpp"
+
+#include <string>
+#include <unordered_set>
+
+class KeyspaceListener {
+public:
+  /*
+  Connects and subscribes to __keyspace@<db>__:<pattern>.
+    - Checks that the server publishes keyspace events (notify-keyspace-events).
+    - Throws std::runtime_error if the server cannot be reached or events are disabled.
+  */
+  KeyspaceListener(const RedisEndpoint& endpoint, int db, const std::string& pattern);
+
+  /*
+  Waits up to timeout_ms for notifications and adds the keys they name to 'changed'.
+    - Returns how many notifications were read.
+    - Throws std::runtime_error when the connection is lost; events may have been missed.
+  */
+  size_t Poll(std::unordered_set<std::string>& changed, int timeout_ms);
+
+private:
+  RedisClient client;
+  RespParser parser;
+  // "__keyspace@<db>__:", stripped from channel names to get the key
+  std::string channel_prefix;
+};
@@ -0,0 +1,59 @@
+/*
+pubsub_subscriber.hpp
+
+  Dedicated connection that receives Pub/Sub messages from a set of channels
+  and channel patterns. Messages are parsed incrementally out of the receive
+  segments and handed out as views, so payloads are never copied here.
+*/
+#pragma once
+#include "transport/redis_client.hpp"
+#include "transport/redis_endpoint.hpp"
+
+#include <chrono>
+#include <string>
+#include <string_view>
+#include <vector>
+
+struct PubSubMessage {
+  std::string_view channel;
+  // Pattern that matched the channel; empty for messages of a plainly subscribed channel.
+  std::string_view pattern;
+  std::string_view payload;
+  // When the segment holding the message was read; shared by every message of one Poll().
+  std::chrono::system_clock::time_point received;
+};
+
+class PubSubSubscriber {
+public:
+  /*
+  Connects and subscribes.
+    - Names containing glob characters (*, ? or [) are PSUBSCRIBEd, all others SUBSCRIBEd.
+    - Waits for every subscription to be confirmed; messages arriving in between are kept.
+    - Throws std::runtime_error if the server cannot be reached or refuses a subscription.
+  */
+  PubSubSubscriber(const RedisEndpoint& endpoint, const std::vector<std::string>& channels);
+
+  /*
+  Waits up to timeout_ms for messages and appends them to 'messages'.
+    - Returns how many messages were appended; 0 on timeout.
+    - The views point into Segments() and stay valid only while a reference to
+      those segments is held; take one before calling Release().
+    - Throws std::runtime_error when the connection is lost; messages may have been missed.
+  */
+  size_t Poll(std::vector<PubSubMessage>& messages, int timeout_ms);
+
+  // Receive segments the messages of the last Poll() point into.
+  const std::vector<SegmentRef>& Segments() const { return client.ReceiveSegments(); }
+
+  // Lets go of everything Poll() returned so far; a partially received message is kept.
+  void Release();
+
+  // Names with a glob character are subscribed to as patterns.
+  static bool IsPattern(std::string_view name);
+
+private:
+  RedisClient client;
+  RespParser parser;
+  // Parser objects already turned into messages (or skipped) by Poll().
+  size_t consumed = 0;
+};
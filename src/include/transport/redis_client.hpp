@@ -2,44 +2,121 @@
 #define REDIS_CLIENT_HPP
 
 #include "transport/socket_os.hpp"
+#include "transport/redis_endpoint.hpp"
 #include "transport/resp_parser.hpp"
+#include "transport/resp_encoder.hpp"
+#include "transport/segment_pool.hpp"
+#include "transport/tls_context.hpp"
 
+#include <chrono>
+#include <stdexcept>
 #include <string>
 #include <vector>
 #include <iostream>
 
+/*
+  Destination for bulk replies that are too large to go through the receive segments.
+  Once the $<len> header of such a reply is known the client asks the sink for
+  final storage and receives the payload straight into it.
+*/
+class LargeValueSink {
+public:
+  virtual ~LargeValueSink() = default;
+  // Returns len writable bytes for reply number 'index' of the current pipeline.
+  virtual char* Allocate(size_t index, size_t len) = 0;
+  // Called once all len bytes have been written.
+  virtual void Finish(size_t index) {}
+};
+
+
+// A reply did not arrive before the request deadline. The connection is closed: the reply may still come.
+class RedisTimeoutError : public std::runtime_error {
+public:
+  using std::runtime_error::runtime_error;
+};
 
-constexpr size_t BUFFER_SIZE = 16384;
 
 class RedisClient {
 private:
 
   SOCKET sock_fd;
   bool is_connected;
+  // Commands sent whose replies have not been read yet.
+  int64_t outstanding;
 
   /*
-     - buffer: Pointer to the start of the memory block
-     - capacity: How big the block is
-     - offset: Where we are currently writing in the buffer
+     - chain: pooled receive segments. Segments never move, so views held by the
+       parser stay valid while a segment is referenced.
+     - parsed_offset: bytes of the tail segment already turned into RespObjects
   */
-  char* buffer;
-  size_t buffer_capacity;
-  size_t current_offset;
+  SegmentChain chain;
+  size_t parsed_offset;
   std::string query;
+  // Reused for every command so encoding does not allocate once warmed up.
+  RespEncoder encoder;
 
   /*
-    Grow buffer if a Redis response is larger than the buffer
+     - ssl: TLS session on top of sock_fd (rediss://), nullptr for plain TCP
+     - ktls_send: the kernel encrypts sends, so plaintext can go out with sendmsg()
+     - session_key: endpoint name the TLS session is cached under
+     - tls_out: staging buffer that packs small commands into full TLS records
   */
-  void EnsureBufferSize(size_t needed_size);
+  SSL* ssl;
+  bool ktls_send;
+  std::string session_key;
+  std::vector<char> tls_out;
+  // Reason of the last failed Open(), see LastError().
+  std::string last_error;
+
+  // The next bytes of a reply must arrive by then; unset (epoch) when there is no deadline.
+  std::chrono::steady_clock::time_point deadline;
+  // Starts the deadline again (see request_timeout_ms): on every send and whenever bytes arrive.
+  void ArmDeadline();
+  // Waits for the socket to become readable; throws RedisTimeoutError once the deadline has passed.
+  void WaitForBytes();
 
+  /*
+  recv()/SSL_read() into buf: > 0 bytes read, 0 closed by the server, < 0 error.
+    - Plain sockets are read first and only polled when nothing is there yet.
+    - Throws RedisTimeoutError if nothing arrives before the deadline.
+  */
+  int RecvSome(char* buf, size_t len);
+  // Writes len bytes through TLS, returns false if the connection failed.
+  bool TlsWrite(const char* data, size_t len);
+  // SendEncoded() for TLS connections without kernel offload.
+  bool SendTls(RespEncoder& package);
+  void FreeTls();
+
+  // Opens sock_fd to unix_path, or to host:port over TCP (IPv4 or IPv6).
+  bool OpenSocket();
+  // (Re)connects to the current target: socket, TLS, AUTH, PING and SELECT.
+  bool Open();
+
+  // Receives whatever is available into the tail segment (at least one byte).
+  void ReceiveMore();
+  // Receives exactly len bytes into caller owned memory, bypassing the segments.
+  void ReceiveExact(char* dest, size_t len);
+  // ReadReplies() for bulk replies, diverting payloads >= threshold into the sink.
+  void ReadValueReplies(RespParser& resp_parser, size_t count, LargeValueSink& sink, size_t threshold);
 
 public:
 
   std::string host = "127.0.0.1";
   int port = 6379;
+  // Wrap the connection in TLS (rediss://).
+  bool tls = false;
+  // Connect to this Unix domain socket instead of host:port when set.
+  std::string unix_path;
+  // Logical database selected after connecting.
+  int db = 0;
+  // Sent with AUTH before anything else when password is set.
+  std::string username;
+  std::string password;
   float connection_timeout = 5;
+  // Longest wait for the next bytes of a reply, in milliseconds; 0 waits for as long as the socket allows.
+  int64_t request_timeout_ms = 5000;
 
-  // Constructor: allocates the empty buffer.
+  // Constructor: receive segments are taken from the pool lazily.
   RedisClient();
   // Destructor: calls CLOSE_SOCKET()
   ~RedisClient();
@@ -50,23 +127,113 @@ public:
     - Returns true if the handshake succeeded.
   */
   bool Connect(const char* host, int port);
+  // Connects to an endpoint (TCP or Unix socket, TLS, database) and remembers it for reconnects.
+  bool Connect(const RedisEndpoint& endpoint);
 
   // Manually closes the connection.
   void Disconnect();
 
+  bool IsConnected() const { return is_connected; }
+  // Why the last Connect() failed: socket, TLS handshake (with OpenSSL's reason), AUTH or SELECT.
+  const std::string& LastError() const { return last_error; }
+  // A client may only be reused by someone else once this is 0.
+  int64_t Outstanding() const { return outstanding; }
+  // Replies are ready to be read (or the connection closed) within timeout_ms.
+  bool WaitReadable(int timeout_ms);
+  /*
+  Waits until one of the clients can be read.
+    - Returns its index, or -1 when none became readable within timeout_ms.
+  */
+  static int WaitAnyReadable(RedisClient* const* clients, size_t count, int timeout_ms);
+
+  // TLS only: the handshake resumed a cached session.
+  bool SessionReused() const { return ssl && SSL_session_reused(ssl); }
+  // TLS only: sends are encrypted by the kernel.
+  bool KernelTlsSend() const { return ktls_send; }
+
 
   std::vector<std::string_view> RedisScan(std::string& query, RespParser& resp_parser);
   std::string_view RedisGet(const std::string& key, RespParser& resp_parser);
 
+  /*
+  Pipelines one GET per key.
+    - All commands are flushed with a single scatter-gather send.
+    - Returns the parser's objects: one reply per key, in key order.
+    - Keys are referenced, not copied, and must stay alive for the call.
+    - With a sink, values of at least large_threshold bytes are streamed into it;
+      their objects then point at the sink's memory instead of a segment.
+  */
+  const RespTape& RedisGetPipelined(const std::vector<std::string_view>& keys, RespParser& resp_parser,
+                                                   LargeValueSink* sink = nullptr, size_t large_threshold = 0);
+
+  /*
+  Sends one command and waits for its reply.
+    - Clears the parser and the receive buffer first.
+    - The reply lives in resp_parser until the next ClearObjects()/ClearBuffer().
+  */
+  const RespObject& RunCommand(const std::vector<std::string_view>& args, RespParser& resp_parser);
+
+  /*
+  The two halves of RedisGetPipelined(), so pipelines to several servers can be
+  sent first and read afterwards while all servers work at the same time.
+  */
+  void SendGetPipeline(const std::vector<std::string_view>& keys);
+  const RespTape& ReadGetPipeline(size_t count, RespParser& resp_parser,
+                                                 LargeValueSink* sink = nullptr, size_t large_threshold = 0);
+
+  /*
+  Runs a Lua script through the server side script cache.
+    - Sends EVALSHA and only uploads the script (SCRIPT LOAD) when the server answers NOSCRIPT.
+    - Returns the script's reply; it lives in resp_parser until the next ClearObjects().
+  */
+  const RespObject& EvalCached(const std::string& script, const std::string& sha1,
+                               const std::vector<std::string_view>& args, RespParser& resp_parser);
+  // Lower case hex SHA1 of a script, as used by EVALSHA.
+  static std::string ScriptSha1(const std::string& script);
+
   /*
   Reads the raw bytes back from the socket.
     - Returns a pointer to the internal 'buffer'.
     - Returns how long the data is (size_t)
   */
-  std::vector<RespObject> CheckedReadResponse(RespParser& resp_parser);
+  RespTape CheckedReadResponse(RespParser& resp_parser);
   bool CheckedSend(const std::string& package);
 
+  /*
+  Flushes every command in the encoder with writev/sendmsg and clears it.
+    - Handles partial writes; returns false if the socket failed.
+  */
+  bool SendEncoded(RespEncoder& package);
+
+  /*
+  Receives until 'count' more complete replies have been parsed.
+    - Parser objects always map onto the bytes in this client's buffer, so the
+      parser must be cleared together with ClearBuffer().
+  */
+  void ReadReplies(RespParser& resp_parser, size_t count);
+
+  /*
+  Reads messages the server pushes on its own (pub/sub), waiting at most timeout_ms.
+    - Returns how many complete messages were parsed; 0 on timeout.
+    - Pushed messages are not counted as outstanding replies.
+  */
+  size_t ReadPushed(RespParser& resp_parser, int timeout_ms);
+
+  /*
+  Drops the receive segments behind everything parsed so far but keeps a
+  partially received message, unlike ClearBuffer().
+    - The tail segment is kept, and received into, while it has room; views into it stay valid.
+    - Call together with RespParser::ClearObjects().
+  */
+  void ReleaseParsed();
+
+  /*
+  Drops the client's references to its receive segments.
+    - Call together with RespParser::ClearObjects().
+    - Take a copy of ReceiveSegments() first to keep parsed strings alive.
+  */
   void ClearBuffer();
+  const std::vector<SegmentRef>& ReceiveSegments() const { return chain.Segments(); }
 };
 
 #endif // REDIS_CLIENT_HPP
\ No newline at end of file
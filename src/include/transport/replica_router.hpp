@@ -0,0 +1,163 @@
+/*
+replica_router.hpp
+
+  Decides which server answers a read. Lookups are spread over the replicas by
+  latency and load, scans are pinned to one replica, and replicas that lag too
+  far behind (or are down) fall back to the primary.
+    - Which replicas a query may use, and its read policy, come from the
+      session that runs it (a RedisRoute). The router only shares the nodes:
+      their pools, latency and health.
+    - Replica health and lag are probed by a background thread, so queries
+      never wait for a slow or unreachable replica.
+*/
+#pragma once
+#include "transport/connection_pool.hpp"
+#include "transport/redis_endpoint.hpp"
+
+#include <array>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <utility>
+#include <vector>
+
+// Replicas more than this many bytes of replication stream behind their primary are not read from.
+constexpr int64_t DEFAULT_MAX_REPLICA_LAG_BYTES = 1024 * 1024;
+
+struct RedisNode {
+  RedisEndpoint endpoint;
+  bool primary = false;
+  std::shared_ptr<ConnectionPool> pool;
+
+  // Guarded by the router's lock.
+  double latency_ms = 1.0;   // EWMA of pipeline round trips
+  size_t inflight = 0;       // lookups sent but not answered yet
+  int64_t lag_bytes = 0;     // replicas: replication offset behind the primary's at the last probe
+  // Replicas are not read from until the first probe has found them in sync.
+  bool healthy = false;
+  // Ring of the most recent round trips, for the hedging threshold.
+  std::array<double, 64> samples{};
+  size_t sample_count = 0;
+
+  // Only used by the prober thread: its own connection, with a short timeout.
+  std::unique_ptr<RedisClient> probe;
+};
+
+// How reads react to slow or failing servers.
+struct ReadPolicy {
+  // Longest a request may go without receiving reply bytes; 0 waits for as long as the socket allows.
+  int64_t timeout_ms = 5000;
+  // Times a failed or timed out read is sent again, to another node where possible.
+  int64_t retries = 2;
+  // Re-issue a read to a second node (or connection) once it has been pending longer than the node's p95.
+  bool hedge = false;
+};
+
+using RedisNodeRef = std::shared_ptr<RedisNode>;
+
+// The servers one query reads from and how, fixed when it binds.
+struct RedisRoute {
+  RedisNodeRef primary;
+  std::vector<RedisNodeRef> replicas;
+  // Replicas further behind than this many bytes are skipped; negative disables the check.
+  int64_t max_lag_bytes = DEFAULT_MAX_REPLICA_LAG_BYTES;
+  ReadPolicy policy;
+};
+
+using RedisRouteRef = std::shared_ptr<const RedisRoute>;
+
+class ReplicaRouter {
+public:
+  ReplicaRouter();
+  // Stops the prober thread.
+  ~ReplicaRouter();
+
+  // Points the router at a new primary and forgets all replicas.
+  void SetPrimary(const RedisEndpoint& endpoint);
+  RedisNodeRef PrimaryNode();
+
+  /*
+  A route over the current primary and these replicas. An empty list sends every read to the primary.
+    - Replicas keep their node (pool and statistics) across routes until the primary changes.
+    - Replicas seen for the first time are probed in the background; until then reads use the others.
+  */
+  RedisRouteRef Route(const std::vector<RedisEndpoint>& replicas, int64_t max_lag_bytes, const ReadPolicy& policy);
+
+  // A route that reads from node only, whatever the current primary is.
+  RedisRouteRef Route(const RedisNodeRef& node, const ReadPolicy& policy);
+
+  /*
+  The node of a server that is neither the primary nor one of its replicas (endpoint := ...).
+    - Nodes are kept, with their pools, for as long as the router lives; repeated lookups share them.
+  */
+  RedisNodeRef EndpointNode(const RedisEndpoint& endpoint);
+
+  // A node of its own for endpoint, owned by the caller (an attached Redis); its pool closes with it.
+  static RedisNodeRef NewNode(const RedisEndpoint& endpoint);
+
+  // Asks the primary for its replicas (ROLE); the answer is reused for DISCOVERY_INTERVAL.
+  std::vector<RedisEndpoint> DiscoverReplicas();
+
+  // The replica for a whole scan: healthy, within the lag bound, lowest latency. Falls back to the primary.
+  RedisNodeRef PickScanNode(const RedisRoute& route);
+
+  /*
+  Splits 'count' lookups over the eligible replicas of route.
+    - Shares are proportional to 1 / (latency * (1 + inflight)).
+    - Returns (node, share) pairs; the shares add up to count.
+    - Shares are counted as in flight until FinishReads().
+  */
+  std::vector<std::pair<RedisNodeRef, size_t>> SplitReads(const RedisRoute& route, size_t count);
+  // A negative elapsed_ms (failed read) releases the share without a latency sample.
+  void FinishReads(const RedisNodeRef& node, size_t count, double elapsed_ms);
+
+  // Marks a node as failed; it is skipped until the prober finds it healthy again.
+  void MarkFailed(const RedisNodeRef& node);
+
+  /*
+  How long a read on node may stay unanswered before it is hedged: the p95 of its recent round trips.
+    - Negative while there are fewer than MIN_HEDGE_SAMPLES samples.
+  */
+  double HedgeDelay(const RedisNodeRef& node);
+
+  // Another node of route to send a retried or hedged read to; 'avoid' itself when it is the only candidate.
+  RedisNodeRef PickAlternative(const RedisRoute& route, const RedisNodeRef& avoid);
+
+private:
+  // Time between two probes of every replica.
+  static constexpr std::chrono::seconds CHECK_INTERVAL{1};
+  // Connect and reply timeout of a probe; a replica that misses it is not read from.
+  static constexpr int PROBE_TIMEOUT_MS = 500;
+  // Minimum time between two ROLE discoveries.
+  static constexpr std::chrono::seconds DISCOVERY_INTERVAL{30};
+  // Weight of the newest sample in the latency EWMA.
+  static constexpr double LATENCY_ALPHA = 0.2;
+  // Round trips a node needs before its p95 is trusted for hedging.
+  static constexpr size_t MIN_HEDGE_SAMPLES = 16;
+
+  std::mutex lock;
+  RedisNodeRef primary;
+  // Every replica of the current primary some route has used.
+  std::vector<RedisNodeRef> replicas;
+  std::vector<RedisEndpoint> discovered_replicas;
+  // Servers read from with endpoint := ..., by endpoint.
+  std::vector<RedisNodeRef> endpoint_nodes;
+  std::chrono::steady_clock::time_point discovered{};
+
+  std::thread prober;
+  std::condition_variable probe_wakeup;
+  bool probe_requested = false;
+  bool stopping = false;
+
+  // Replicas of route that may serve reads right now. Call with the lock held.
+  std::vector<RedisNodeRef> EligibleReplicas(const RedisRoute& route);
+  // Probes every replica once per CHECK_INTERVAL until the router is destroyed.
+  void ProbeLoop();
+  // INFO replication on node over its probe connection; an empty view when it cannot be reached.
+  std::string_view ProbeInfo(RedisNode& node, RespParser& parser);
+  // Updates health and lag of one replica against the primary's replication offset (-1 when unknown).
+  void CheckReplica(RedisNode& node, int64_t primary_offset);
+};
@@ -0,0 +1,178 @@
+/*
+resp_encoder.hpp
+
+  Writes RESP commands into a reusable output buffer so a whole pipeline of
+  commands can be flushed with one scatter-gather send.
+*/
+#pragma once
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <string_view>
+#include <vector>
+
+namespace resp {
+
+// Compile time RESP fragments ---------------------------------------------------------------
+// Constant parts of a command (array header, command name, fixed options) never change, so
+// they are encoded once by the compiler instead of being rebuilt for every request.
+
+template <size_t N>
+struct Literal {
+  std::array<char, N> data{};
+  size_t len = 0;
+
+  constexpr void Append(char c) { data[len++] = c; }
+
+  constexpr void Append(std::string_view text) {
+    for (char c : text) {
+      Append(c);
+    }
+  }
+
+  constexpr void AppendNumber(size_t value) {
+    char digits[20]{};
+    size_t count = 0;
+    do {
+      digits[count++] = static_cast<char>('0' + value % 10);
+      value /= 10;
+    } while (value != 0);
+    while (count > 0) {
+      Append(digits[--count]);
+    }
+  }
+
+  constexpr std::string_view View() const { return std::string_view(data.data(), len); }
+};
+
+// "$<len>\r\n<arg>\r\n"
+template <size_t N>
+constexpr auto Bulk(const char (&arg)[N]) {
+  Literal<N + 24> out;
+  out.Append('$');
+  out.AppendNumber(N - 1);
+  out.Append("\r\n");
+  out.Append(std::string_view(arg, N - 1));
+  out.Append("\r\n");
+  return out;
+}
+
+// "*<argc>\r\n$<len>\r\n<name>\r\n"
+template <size_t N>
+constexpr auto Command(size_t argc, const char (&name)[N]) {
+  Literal<N + 48> out;
+  out.Append('*');
+  out.AppendNumber(argc);
+  out.Append("\r\n");
+  out.Append(Bulk(name).View());
+  return out;
+}
+
+template <size_t A, size_t B>
+constexpr auto Concat(const Literal<A>& lhs, const Literal<B>& rhs) {
+  Literal<A + B> out;
+  out.Append(lhs.View());
+  out.Append(rhs.View());
+  return out;
+}
+
+inline constexpr auto GET_PREFIX = Command(2, "GET");
+inline constexpr auto SCAN_PREFIX = Command(6, "SCAN");
+inline constexpr auto MATCH_ARG = Bulk("MATCH");
+inline constexpr auto COUNT_ARG = Bulk("COUNT");
+
+// Per-key metadata lookups (keyspace profiling); each is followed by the key.
+inline constexpr auto TYPE_PREFIX = Command(2, "TYPE");
+inline constexpr auto PTTL_PREFIX = Command(2, "PTTL");
+inline constexpr auto OBJECT_ENCODING_PREFIX = Concat(Command(3, "OBJECT"), Bulk("ENCODING"));
+inline constexpr auto OBJECT_IDLETIME_PREFIX = Concat(Command(3, "OBJECT"), Bulk("IDLETIME"));
+inline constexpr auto MEMORY_USAGE_PREFIX = Concat(Command(3, "MEMORY"), Bulk("USAGE"));
+// HMGET takes a variable number of fields, so only its name is pre-encoded.
+inline constexpr auto HMGET_ARG = Bulk("HMGET");
+inline constexpr auto HGETALL_PREFIX = Command(2, "HGETALL");
+// Ranges (see RespEncoder::EncodeRange): LRANGE of a list, GETRANGE of a string's bytes.
+inline constexpr auto LRANGE_PREFIX = Command(4, "LRANGE");
+inline constexpr auto GETRANGE_PREFIX = Command(4, "GETRANGE");
+inline constexpr auto LLEN_PREFIX = Command(2, "LLEN");
+
+static_assert(GET_PREFIX.View() == "*2\r\n$3\r\nGET\r\n");
+static_assert(SCAN_PREFIX.View() == "*6\r\n$4\r\nSCAN\r\n");
+static_assert(OBJECT_ENCODING_PREFIX.View() == "*3\r\n$6\r\nOBJECT\r\n$8\r\nENCODING\r\n");
+
+} // namespace resp
+
+/*
+  One contiguous piece of the encoded output. Pieces either point into the
+  encoder's own buffer or directly at a caller-owned argument string.
+*/
+struct RespSlice {
+  const char* ptr;
+  size_t len;
+};
+
+class RespEncoder {
+public:
+  /*
+    Arguments up to this size are copied into the output buffer; larger ones are
+    referenced in place. Below this size an extra iovec costs more than the copy.
+  */
+  static constexpr size_t INLINE_ARG_LIMIT = 64;
+
+  // Appends pre-encoded bytes (see resp::Command / resp::Bulk).
+  void AppendRaw(std::string_view fragment);
+  void AppendArrayHeader(size_t count);
+
+  /*
+    Appends one bulk string argument.
+      - Large arguments are NOT copied: the caller must keep them alive until the
+        encoder has been flushed or cleared.
+  */
+  void AppendBulk(std::string_view arg);
+  void AppendBulk(int64_t value);
+
+  // Appends a generic command. Marks the end of a command for CommandCount().
+  void AppendCommand(const std::vector<std::string_view>& args);
+
+  void EncodeGet(std::string_view key);
+  // A command whose only argument after a pre-encoded prefix is the key (see resp::TYPE_PREFIX).
+  void EncodeKeyCommand(std::string_view prefix, std::string_view key);
+  // <prefix> key start stop, e.g. one LRANGE window of a list; both bounds are inclusive.
+  void EncodeRange(std::string_view prefix, std::string_view key, int64_t start, int64_t stop);
+  void EncodeScan(std::string_view cursor, std::string_view pattern, size_t count = 2048);
+
+  // Marks the end of a hand assembled command.
+  void EndCommand() { ++command_count; }
+
+  /*
+    Resolves the scatter-gather list of everything encoded so far.
+      - Pointers are valid until the next Append*() or Clear().
+  */
+  const std::vector<RespSlice>& Slices();
+
+  size_t CommandCount() const { return command_count; }
+  size_t ByteSize() const { return total_bytes; }
+  bool Empty() const { return command_count == 0; }
+
+  // Drops encoded commands but keeps the allocated capacity for the next batch.
+  void Clear();
+
+private:
+  /*
+    Pieces are stored as offsets while encoding because the output buffer may
+    still grow (and move); they are turned into pointers in Slices().
+  */
+  struct Piece {
+    const char* external; // nullptr when the bytes live in 'out'
+    size_t offset;
+    size_t len;
+  };
+
+  std::vector<char> out;
+  std::vector<Piece> pieces;
+  std::vector<RespSlice> slices;
+  size_t command_count = 0;
+  size_t total_bytes = 0;
+
+  void AppendOwned(const char* data, size_t len);
+  void AppendExternal(const char* data, size_t len);
+};
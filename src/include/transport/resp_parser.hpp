@@ -1,4 +1,7 @@
 #pragma once
+#include "transport/transport_memory.hpp"
+
+#include <stdexcept>
 #include <string>
 #include <vector>
 #include <variant>
@@ -24,6 +27,16 @@ enum class RespType {
   VERBATIM_STRING   // =
 };
 
+// A reply that can never parse, however many more bytes arrive (as opposed to an incomplete one).
+class RespProtocolError : public std::runtime_error {
+public:
+  using std::runtime_error::runtime_error;
+};
+
+struct RespObject;
+// Parsed replies; allocated through the transport allocator, so large pipelines are accounted for.
+using RespTape = std::vector<RespObject, TapeAllocator<RespObject>>;
+
 struct RespObject {
   RespType type;
   union {
@@ -37,7 +50,7 @@ struct RespObject {
   };
 
   // Only Arrays/maps need dynamic memory .
-  std::vector<RespObject> children;
+  RespTape children;
 
   std::string_view AsString() const {
     return std::string_view(str_view.ptr, str_view.len);
@@ -46,15 +59,23 @@ struct RespObject {
 
 class RespParser{
 public:
-  void ParseBuffer(const char* buffer, size_t length);
-  std::vector<RespObject> GetObjects();
+  /*
+  Parses up to max_objects complete objects from the buffer.
+    - Returns how many bytes were consumed; a trailing incomplete object is left
+      untouched so it can be parsed again once the rest of it was received.
+    - Throws RespProtocolError for malformed replies, such as an integer that does not fit 64 bits.
+  */
+  size_t ParseBuffer(const char* buffer, size_t length, size_t max_objects = SIZE_MAX);
+  // Registers an object that was read outside of the parser (e.g. a streamed large value).
+  void PushObject(const RespObject& obj) { RespObjects.push_back(obj); }
+  RespTape GetObjects();
+  const RespTape& Objects() const { return RespObjects; }
+  size_t ObjectCount() const { return RespObjects.size(); }
   void PrintResp(const RespObject& obj, int indent = 0);
-  std::string BuildScan(const std::string& cursor, const std::string& pattern);
-  std::string BuildGet(const std::string& pattern);
   void SqlToResp(std::string &query);
   void ClearObjects() { RespObjects.clear(); }
 private:
-  std::vector<RespObject> RespObjects;
+  RespTape RespObjects;
 
   template <typename T>
   auto ParseNumeric(const char*& cursor, const char* end) -> T;
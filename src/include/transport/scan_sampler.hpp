@@ -0,0 +1,78 @@
+/*
+scan_sampler.hpp
+
+  Server side sampling for SCAN. Redis walks its hash table in reverse-binary
+  cursor order, so a cursor with its bits reversed is a position in the walk
+  that does not depend on the table size. The walk is cut into equal slices and
+  only a seeded random subset of them is scanned; the pages in between are
+  skipped by jumping the cursor instead of being fetched.
+*/
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+
+class ScanSampler {
+public:
+  // Most slices the walk is cut into (a power of two, so slices line up with hash buckets).
+  static constexpr uint64_t MAX_SLICES = 8192;
+  // Upper bound of the COUNT hint; the hint shrinks near the end of a slice so pages stop close to it.
+  static constexpr size_t MAX_COUNT = 2048;
+
+  /*
+  Picks round(fraction * slices) slices of the walk.
+    - key_count (DBSIZE) caps the number of slices at the largest power of two it reaches. Redis keeps
+      at least that many buckets, so no slice is narrower than a bucket: SCAN returns whole buckets,
+      and two slices inside one bucket would read it twice while counting for two different slices.
+    - The same fraction, seed and table size always pick the same slices (std::mt19937_64 and a
+      fixed shuffle), so a sample of an unchanged keyspace is reproducible.
+  */
+  ScanSampler(double fraction, uint64_t seed, uint64_t key_count);
+
+  // Share of the walk that is sampled: the requested fraction rounded to whole slices.
+  double Fraction() const;
+  // Share of the walk actually covered by the pages read so far (pages may end a little past a slice).
+  double ScannedFraction() const;
+
+  // Cursor and COUNT hint for the next SCAN call.
+  const std::string& Cursor() const { return cursor; }
+  size_t Count() const { return count; }
+  bool Done() const { return done; }
+
+  /*
+  Takes the cursor SCAN returned and moves on.
+    - Stays in the current slice until the walk passes its end, then jumps to the next picked slice.
+    - Buckets are never visited twice.
+  */
+  void Advance(std::string_view returned_cursor);
+
+private:
+  uint64_t slice_count;
+  // log2(slice_count)
+  unsigned slice_bits = 0;
+  // Picked slice numbers, ascending.
+  std::vector<uint64_t> slices;
+  size_t current = 0;
+  // Position (reversed cursor) the walk has reached so far, and where the pending call started.
+  uint64_t covered = 0;
+  uint64_t call_start = 0;
+  // Walk positions covered so far.
+  long double scanned_positions = 0;
+  /*
+  Keys per position, from DBSIZE: what sizes the COUNT hint. SCAN counts the keys it walks, matching
+  or not, so the density of the keys a MATCH pattern let through would ask for far too much.
+  */
+  long double key_density;
+  std::string cursor;
+  size_t count = 1;
+  bool done = false;
+
+  uint64_t SliceStart(uint64_t slice) const;
+  uint64_t SliceEnd(uint64_t slice) const;
+  // Jumps to the first picked slice that still has unvisited positions.
+  void Seek();
+  // COUNT hint for reaching the end of the current slice from 'covered'.
+  void SizeCount();
+};
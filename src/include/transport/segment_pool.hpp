@@ -0,0 +1,92 @@
+/*
+segment_pool.hpp
+
+  Receive memory for RedisClient. Replies are read into a chain of fixed
+  segments that never move, so string_views handed out by the parser stay
+  valid until the last reference to their segment is dropped.
+  Segment memory comes from the installed TransportAllocator.
+*/
+#pragma once
+#include "transport/transport_memory.hpp"
+
+#include <cstddef>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+// Size of a standard pooled segment. Larger replies get a dedicated segment.
+constexpr size_t SEGMENT_SIZE = 64 * 1024;
+
+struct BufferSegment {
+  char* data;
+  size_t capacity;
+  size_t used;
+  // Allocator data came from, and goes back to.
+  TransportAllocator* allocator;
+
+  size_t Space() const { return capacity - used; }
+};
+
+// Segments are reference counted; the last owner hands the memory back to the pool.
+using SegmentRef = std::shared_ptr<BufferSegment>;
+
+class SegmentPool {
+public:
+  // Process wide pool shared by every client and scan thread.
+  static SegmentPool& Instance();
+
+  /*
+  Returns an empty segment of at least min_capacity bytes.
+    - Standard sized segments are recycled, larger ones are allocated exactly.
+    - Nothing is recycled while the allocator reports memory pressure; a segment released then
+      also frees every idle one.
+  */
+  SegmentRef Acquire(size_t min_capacity = SEGMENT_SIZE);
+
+  size_t IdleCount();
+  // Frees every idle segment.
+  void Trim();
+
+private:
+  struct IdleSegment {
+    char* data;
+    TransportAllocator* allocator;
+  };
+
+  // Caps how much idle memory the pool keeps around (max_idle * SEGMENT_SIZE).
+  size_t max_idle = 256;
+  std::mutex lock;
+  std::vector<IdleSegment> idle;
+
+  void Release(BufferSegment* segment);
+};
+
+class SegmentChain {
+public:
+  // Where the next recv() writes, and how much room is left there.
+  char* WritePtr() { return tail->data + tail->used; }
+  size_t WriteSpace() const { return tail ? tail->Space() : 0; }
+  void Commit(size_t bytes) { tail->used += bytes; }
+
+  const char* TailData() const { return tail ? tail->data : nullptr; }
+  size_t TailUsed() const { return tail ? tail->used : 0; }
+
+  /*
+  Starts a new tail segment with at least min_space free bytes.
+    - Bytes from keep_from to the end of the old tail (an incomplete reply) are
+      copied into the new segment; everything before stays where it is.
+  */
+  void Roll(size_t keep_from, size_t min_space);
+
+  // References to every segment, used to keep parsed views alive after Clear().
+  const std::vector<SegmentRef>& Segments() const { return segments; }
+
+  // Drops this chain's references. Segments still pinned elsewhere stay alive.
+  void Clear();
+  // Drops every segment except the tail.
+  void DropBeforeTail();
+
+private:
+  std::vector<SegmentRef> segments;
+  BufferSegment* tail = nullptr;
+};
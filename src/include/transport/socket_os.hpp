@@ -39,10 +39,14 @@ inline void cleanup_sockets() {
 #else
 
 #include <sys/socket.h>
+#include <sys/un.h>
 #include <arpa/inet.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
 #include <netdb.h>
 #include <unistd.h>
 #include <errno.h>
+#include <poll.h>
 
 typedef int SOCKET;
 
@@ -72,4 +76,83 @@ inline void set_socket_timeout(SOCKET s, int seconds) {
   setsockopt(s, SOL_SOCKET, SO_RCVTIMEO, (const void*)&timeout, sizeof(timeout));
   setsockopt(s, SOL_SOCKET, SO_SNDTIMEO, (const void*)&timeout, sizeof(timeout));
 #endif
-}
\ No newline at end of file
+}
+
+// Kernel send and receive buffer size: room for several receive segments of pipelined replies.
+constexpr int SOCKET_BUFFER_SIZE = 1 << 20;
+
+// Sized buffers for every socket; TCP sockets also disable Nagle so small pipelines go out at once.
+inline void set_low_latency(SOCKET s, bool tcp) {
+  int buffer = SOCKET_BUFFER_SIZE;
+  setsockopt(s, SOL_SOCKET, SO_RCVBUF, (const char*)&buffer, sizeof(buffer));
+  setsockopt(s, SOL_SOCKET, SO_SNDBUF, (const char*)&buffer, sizeof(buffer));
+  if (tcp) {
+    int one = 1;
+    setsockopt(s, IPPROTO_TCP, TCP_NODELAY, (const char*)&one, sizeof(one));
+  }
+}
+
+// Waits until s is readable (or closed). Returns > 0 when ready, 0 on timeout, < 0 on error.
+inline int wait_readable(SOCKET s, int timeout_ms) {
+#ifdef _WIN32
+  WSAPOLLFD pfd{};
+  pfd.fd = s;
+  pfd.events = POLLRDNORM;
+  return WSAPoll(&pfd, 1, timeout_ms);
+#else
+  struct pollfd pfd{};
+  pfd.fd = s;
+  pfd.events = POLLIN;
+  int ready = poll(&pfd, 1, timeout_ms);
+  // a signal is not an error, the caller simply polls again
+  return ready < 0 && errno == EINTR ? 0 : ready;
+#endif
+}
+
+// recv() that never waits: > 0 bytes read, 0 closed, < 0 error. would_block is set when nothing has arrived yet.
+inline int recv_nowait(SOCKET s, char* buf, int len, bool& would_block) {
+#ifdef _WIN32
+  // no per call non-blocking flag on Windows: look at readiness first
+  would_block = wait_readable(s, 0) == 0;
+  return would_block ? -1 : recv(s, buf, len, 0);
+#else
+  int read = static_cast<int>(recv(s, buf, len, MSG_DONTWAIT));
+  would_block = read < 0 && (errno == EAGAIN || errno == EWOULDBLOCK || errno == EINTR);
+  return read;
+#endif
+}
+
+// wait_any_readable() looks at no more than this many sockets.
+constexpr size_t MAX_WAIT_SOCKETS = 8;
+
+// Waits until one of the sockets is readable (or closed). Returns its index, -1 on timeout or error.
+inline int wait_any_readable(const SOCKET* sockets, size_t count, int timeout_ms) {
+#ifdef _WIN32
+  WSAPOLLFD pfds[MAX_WAIT_SOCKETS]{};
+#else
+  struct pollfd pfds[MAX_WAIT_SOCKETS]{};
+#endif
+  count = count < MAX_WAIT_SOCKETS ? count : MAX_WAIT_SOCKETS;
+  for (size_t i = 0; i < count; i++) {
+    pfds[i].fd = sockets[i];
+#ifdef _WIN32
+    pfds[i].events = POLLRDNORM;
+#else
+    pfds[i].events = POLLIN;
+#endif
+  }
+#ifdef _WIN32
+  int ready = WSAPoll(pfds, static_cast<ULONG>(count), timeout_ms);
+#else
+  int ready = poll(pfds, count, timeout_ms);
+#endif
+  if (ready <= 0) {
+    return -1;
+  }
+  for (size_t i = 0; i < count; i++) {
+    if (pfds[i].revents != 0) {
+      return static_cast<int>(i);
+    }
+  }
+  return -1;
+}
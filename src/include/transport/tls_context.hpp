@@ -0,0 +1,39 @@
+/*
+tls_context.hpp
+
+  Process wide OpenSSL client state for rediss:// endpoints: one SSL_CTX and
+  the last resumable session of every endpoint, so pooled reconnects resume
+  instead of running a full handshake.
+*/
+#pragma once
+#include <openssl/ssl.h>
+
+#include <mutex>
+#include <string>
+#include <unordered_map>
+
+class TlsContext {
+public:
+  static TlsContext& Instance();
+
+  /*
+  Creates a client connection object for an already connected socket.
+    - Verifies the server certificate against the system trust store (or SSL_CERT_FILE / SSL_CERT_DIR)
+      and checks it was issued for 'host' (a DNS name or an IP address).
+    - Offers the cached session of session_key for resumption. session_key must outlive the SSL object.
+  */
+  SSL* NewConnection(int fd, const std::string& host, const std::string& session_key);
+
+private:
+  TlsContext();
+
+  SSL_CTX* ctx = nullptr;
+  std::mutex lock;
+  // endpoint -> most recent resumable session (one reference owned by the map)
+  std::unordered_map<std::string, SSL_SESSION*> sessions;
+  // SSL ex_data slot holding the session key of a connection
+  int key_index = -1;
+
+  static int OnNewSession(SSL* ssl, SSL_SESSION* session);
+  void StoreSession(const std::string& key, SSL_SESSION* session);
+};
@@ -0,0 +1,92 @@
+/*
+transport_memory.hpp
+
+  Where the transport gets its bulk memory from: receive segments and parser
+  tapes. By default that is the system heap; an embedding database installs
+  its own allocator so these bytes count against its memory limit.
+*/
+#pragma once
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <type_traits>
+
+class TransportAllocator {
+public:
+  virtual ~TransportAllocator() = default;
+  // May throw when the memory limit is reached.
+  virtual char* Allocate(size_t size) = 0;
+  virtual void Free(char* data, size_t size) = 0;
+  // Memory is getting scarce: read-ahead and caches should shrink.
+  virtual bool UnderPressure() { return false; }
+};
+
+enum class MemoryComponent : uint8_t {
+  SEGMENTS,      // receive segments in use or parked in the pool
+  IDLE_SEGMENTS, // the parked part of SEGMENTS
+  TAPES,         // parsed RespObject arrays
+  COUNT
+};
+
+struct MemoryUsage {
+  int64_t bytes;
+  int64_t peak_bytes;
+};
+
+class TransportMemory {
+public:
+  static TransportMemory& Instance();
+
+  /*
+  Routes new allocations to allocator.
+    - Memory already handed out is freed through the allocator it came from, so allocators
+      must never be destroyed once installed.
+  */
+  void Install(TransportAllocator* allocator);
+  TransportAllocator* Allocator() const { return current.load(std::memory_order_acquire); }
+
+  char* Allocate(TransportAllocator* allocator, MemoryComponent component, size_t size);
+  void Free(TransportAllocator* allocator, MemoryComponent component, char* data, size_t size);
+  // Bookkeeping only, for bytes that change component without being reallocated.
+  void Track(MemoryComponent component, int64_t delta);
+
+  MemoryUsage Usage(MemoryComponent component) const;
+  bool UnderPressure() const { return Allocator()->UnderPressure(); }
+
+private:
+  TransportMemory();
+
+  std::atomic<TransportAllocator*> current;
+  std::array<std::atomic<int64_t>, static_cast<size_t>(MemoryComponent::COUNT)> bytes{};
+  std::array<std::atomic<int64_t>, static_cast<size_t>(MemoryComponent::COUNT)> peak_bytes{};
+};
+
+/*
+  std::allocator replacement for parser tapes.
+    - Remembers the allocator that was current when the container was created,
+      so a container frees through the same allocator it allocated from.
+*/
+template <typename T>
+struct TapeAllocator {
+  using value_type = T;
+  using propagate_on_container_copy_assignment = std::true_type;
+  using propagate_on_container_move_assignment = std::true_type;
+  using propagate_on_container_swap = std::true_type;
+
+  TransportAllocator* backend;
+
+  TapeAllocator() noexcept : backend(TransportMemory::Instance().Allocator()) {}
+  template <typename U>
+  TapeAllocator(const TapeAllocator<U>& other) noexcept : backend(other.backend) {}
+
+  T* allocate(size_t n) {
+    return reinterpret_cast<T*>(TransportMemory::Instance().Allocate(backend, MemoryComponent::TAPES, n * sizeof(T)));
+  }
+  void deallocate(T* ptr, size_t n) noexcept {
+    TransportMemory::Instance().Free(backend, MemoryComponent::TAPES, reinterpret_cast<char*>(ptr), n * sizeof(T));
+  }
+
+  template <typename U>
+  bool operator==(const TapeAllocator<U>& other) const noexcept { return backend == other.backend; }
+};
@@ -0,0 +1,37 @@
+/*
+value_codec.hpp
+
+  Transparent decompression of values written as LZ4 or zstd frames. Both
+  frame formats start with a magic number, so compressed and plain values can
+  be mixed under the same keys.
+*/
+#pragma once
+#include <cstdint>
+#include <string>
+#include <string_view>
+
+enum class ValueCompression : uint8_t {
+  NONE, // values are returned as stored
+  AUTO, // any supported frame is decompressed
+  LZ4,
+  ZSTD
+};
+
+// Codec of the frame at the start of bytes, limited to what 'allowed' accepts; NONE for plain values.
+ValueCompression DetectCompression(std::string_view bytes, ValueCompression allowed);
+
+/*
+Decompressed size recorded in the frame header, or -1 if the writer did not record it.
+  - Only the header is read: callers must check the size against their own limit before allocating it.
+*/
+int64_t FrameContentSize(std::string_view frame, ValueCompression codec);
+
+/*
+Decompresses a frame into exactly size bytes at dest (size from FrameContentSize()).
+  - Returns false for corrupt frames or frames whose content does not match size.
+  - Decompression contexts are kept per thread and reused.
+*/
+bool DecompressFrame(std::string_view frame, ValueCompression codec, char* dest, size_t size);
+
+// Same, for frames without a recorded size; out grows as needed but fails beyond max_size bytes.
+bool DecompressFrame(std::string_view frame, ValueCompression codec, std::string& out, size_t max_size);
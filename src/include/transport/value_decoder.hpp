@@ -0,0 +1,20 @@
+/*
+value_decoder.hpp
+
+  Decodes typed values straight out of reply bytes, without copying them into
+  a std::string first.
+*/
+#pragma once
+#include <cstdint>
+#include <string_view>
+
+/*
+Parses a canonical decimal integer ("-42", as written by INCR/SET).
+  - Eight digits are checked and converted per step (SWAR) instead of one at a time.
+  - Returns false for anything else (signs, spaces, overflow, ...); callers may
+    then fall back to a general purpose conversion.
+*/
+bool ParseDecimalInt64(std::string_view text, int64_t& out);
+
+// True if text is one complete RFC 8259 JSON value (surrounding whitespace allowed).
+bool IsValidJson(std::string_view text);
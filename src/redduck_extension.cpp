@@ -2,14 +2,69 @@
 
 #include "redduck_extension.hpp"
 #include "duckdb.hpp"
+#include "duckdb/catalog/duck_catalog.hpp"
 #include "duckdb/common/exception.hpp"
+#include "duckdb/common/operator/cast_operators.hpp"
+#include "duckdb/common/operator/comparison_operators.hpp"
+#include "duckdb/common/string_util.hpp"
+#include "duckdb/execution/expression_executor.hpp"
+#include "duckdb/function/aggregate_function.hpp"
 #include "duckdb/function/scalar_function.hpp"
+#include "duckdb/main/attached_database.hpp"
+#include "duckdb/main/config.hpp"
+#include "duckdb/main/database_manager.hpp"
+#include "duckdb/main/secret/secret.hpp"
+#include "duckdb/main/secret/secret_manager.hpp"
+#include "duckdb/optimizer/optimizer.hpp"
+#include "duckdb/optimizer/optimizer_extension.hpp"
+#include "duckdb/parallel/task_scheduler.hpp"
+#include "duckdb/parser/keyword_helper.hpp"
+#include "duckdb/parser/parsed_data/attach_info.hpp"
+#include "duckdb/parser/parsed_data/create_view_info.hpp"
+#include "duckdb/parser/parser.hpp"
+#include "duckdb/parser/qualified_name.hpp"
+#include "duckdb/planner/binder.hpp"
+#include "duckdb/planner/expression/bound_aggregate_expression.hpp"
+#include "duckdb/planner/expression/bound_cast_expression.hpp"
+#include "duckdb/planner/expression/bound_columnref_expression.hpp"
+#include "duckdb/planner/expression/bound_comparison_expression.hpp"
+#include "duckdb/planner/expression/bound_constant_expression.hpp"
+#include "duckdb/planner/expression/bound_function_expression.hpp"
+#include "duckdb/parser/parsed_data/sample_options.hpp"
+#include "duckdb/planner/operator/logical_aggregate.hpp"
+#include "duckdb/planner/operator/logical_filter.hpp"
+#include "duckdb/planner/operator/logical_get.hpp"
+#include "duckdb/planner/operator/logical_limit.hpp"
+#include "duckdb/planner/operator/logical_projection.hpp"
+#include "duckdb/planner/operator/logical_sample.hpp"
+#include "duckdb/storage/buffer_manager.hpp"
+#include "duckdb/storage/storage_extension.hpp"
+#include "duckdb/transaction/duck_transaction_manager.hpp"
 #include <duckdb/parser/parsed_data/create_scalar_function_info.hpp>
 
+#include "transport/bitmap_decoder.hpp"
+#include "transport/connection_pool.hpp"
+#include "transport/keyspace_listener.hpp"
+#include "transport/pubsub_subscriber.hpp"
 #include "transport/redis_client.hpp"
+#include "transport/redis_endpoint.hpp"
+#include "transport/replica_router.hpp"
 #include "transport/resp_parser.hpp"
+#include "transport/scan_sampler.hpp"
+#include "transport/transport_memory.hpp"
+#include "transport/value_codec.hpp"
+#include "transport/value_decoder.hpp"
 
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <map>
 #include <mutex>
+#include <random>
+#include <stdexcept>
+#include <thread>
+#include <unordered_map>
+#include <unordered_set>
 #include <openssl/opensslv.h>
 
 namespace duckdb {
@@ -41,22 +96,15 @@ inline void SetNameScalarFun(DataChunk &args, ExpressionState &state, Vector &re
 // -------------------------------------------------------------------------------------------------
 //  redis_scan('address:port') scalar function
 // -------------------------------------------------------------------------------------------------
-RedisClient ScanClient;
-RedisClient GetClient;
-
-std::mutex scan_mutex;
-std::mutex get_mutex;
-
-//shared config
-std::string redis_host = "127.0.0.1";
-int redis_port = 6379;
+// Every read goes through the router: it owns the connection pools of the primary and its replicas.
+ReplicaRouter redis_router;
 
 inline void SetAddressScalarFun(DataChunk &args, ExpressionState &state, Vector &result) {
     auto &input_vector = args.data[0];
 
     // If the user tries: SELECT redis_connect(my_col) FROM table; This triggers FLAT_VECTOR
     if (input_vector.GetVectorType() != VectorType::CONSTANT_VECTOR) {
-        throw duckdb::InvalidInputException("redis_connect() only accepts a constant string (e.g., '127.0.0.1:6379'), not a column.");
+        throw duckdb::InvalidInputException("redis_connect() only accepts a constant string (e.g., '127.0.0.1:6379', 'redis://host:6379/0' or 'unix:///path/redis.sock'), not a column.");
     }
 
     if (ConstantVector::IsNull(input_vector)) {
@@ -66,119 +114,803 @@ inline void SetAddressScalarFun(DataChunk &args, ExpressionState &state, Vector
     auto input_data = ConstantVector::GetData<string_t>(input_vector);
     string_t input_val = input_data[0];
 
-    const char* ptr = input_val.GetData();
-    size_t len = input_val.GetSize();
+    RedisEndpoint endpoint;
+    try {
+        endpoint = ParseEndpoint(std::string_view(input_val.GetData(), input_val.GetSize()));
+    } catch (std::invalid_argument &ex) {
+        throw duckdb::InvalidInputException("Invalid Redis address (%s)", ex.what());
+    }
 
+    redis_router.SetPrimary(endpoint);
+    try {
+        // Borrowing a client connects and PINGs; the connection stays in the pool for the next query.
+        PooledClient lease(redis_router.PrimaryNode()->pool);
+    } catch (std::exception &ex) {
+        throw InvalidInputException("Connection failed: %s", ex.what());
+    }
 
-    const char* colon_pos = (const char*)memchr(ptr, ':', len);
+    result.SetVectorType(VectorType::CONSTANT_VECTOR);
+    auto result_data = ConstantVector::GetData<string_t>(result);
 
-    if (!colon_pos) {
-        throw duckdb::InvalidInputException("Invalid format. Expected 'HOST:PORT'");
-    }
+    std::string success_msg = "Redis Target Set: " + endpoint.ToString();
 
-    size_t host_len = colon_pos - ptr;
-    size_t port_len = len - host_len - 1;
+    // We must use StringVector::AddString to safely allocate memory for the result string
+    result_data[0] = StringVector::AddString(result, success_msg);
+}
+// -------------------------------------------------------------------------------------------------
+//  Zero-copy strings
+// -------------------------------------------------------------------------------------------------
 
-    // Convert to std::string
-    std::string host_str(ptr, host_len);
-    std::string port_str(colon_pos + 1, port_len);
+// Keeps Redis receive segments alive for as long as a DuckDB vector holds strings that point into them.
+// Once the last vector is gone the segments go back to the SegmentPool.
+class RedisSegmentBuffer : public VectorBuffer {
+public:
+	explicit RedisSegmentBuffer(std::vector<SegmentRef> segments_p)
+	    : VectorBuffer(VectorBufferType::OPAQUE_BUFFER), segments(std::move(segments_p)) {
+	}
 
-    int port_int = 0;
-    try { port_int = std::stoi(port_str);
-    } catch (...) {
-        throw duckdb::InvalidInputException("Port must be a valid number");
-    }
+private:
+	std::vector<SegmentRef> segments;
+};
 
-	{
-    	std::scoped_lock lock(scan_mutex, get_mutex);
+static inline string_t SegmentString(std::string_view sv) {
+	return string_t(sv.data(), static_cast<uint32_t>(sv.size()));
+}
 
-    	redis_host = host_str;
-    	redis_port = port_int;
+// -------------------------------------------------------------------------------------------------
+//  Memory accounting: receive segments and parser tapes count against memory_limit
+// -------------------------------------------------------------------------------------------------
 
-    	ScanClient.host = redis_host;
-    	ScanClient.port = redis_port;
+// Share of memory_limit in use above which read-ahead shrinks and idle segments are freed.
+static constexpr double MEMORY_PRESSURE_RATIO = 0.8;
+// SCAN page size (keys read ahead of the output) while memory is under pressure.
+static constexpr size_t PRESSURE_SCAN_COUNT = 256;
 
-    	GetClient.host = redis_host;
-    	GetClient.port = redis_port;
+/*
+  Takes transport memory from the buffer manager's allocator.
+    - DuckDB evicts buffers (or raises an out of memory error) to make room, like for its own allocations,
+      and the bytes show up under the ALLOCATOR tag of duckdb_memory().
+    - Never destroyed once installed (see TransportMemory::Install). Memory released after its database
+      is gone goes back to the default allocator, which the buffer allocator wraps.
+*/
+class DuckDBTransportAllocator : public TransportAllocator {
+public:
+	explicit DuckDBTransportAllocator(DatabaseInstance &db_p) : db(db_p.shared_from_this()) {
+	}
 
-    	if (!ScanClient.Connect(redis_host.c_str(), redis_port)) {
-    		throw InvalidInputException("Connection failed (scan client)");
-    	}
-    	if (!GetClient.Connect(redis_host.c_str(), redis_port)) {
-    		throw InvalidInputException("Connection failed (get client)");
-    	}
+	char *Allocate(size_t size) override {
+		auto instance = db.lock();
+		if (!instance) {
+			return char_ptr_cast(Allocator::DefaultAllocator().AllocateData(size));
+		}
+		return char_ptr_cast(BufferManager::GetBufferManager(*instance).GetBufferAllocator().AllocateData(size));
 	}
 
-    result.SetVectorType(VectorType::CONSTANT_VECTOR);
-    auto result_data = ConstantVector::GetData<string_t>(result);
+	void Free(char *data, size_t size) override {
+		auto instance = db.lock();
+		if (!instance) {
+			Allocator::DefaultAllocator().FreeData(data_ptr_cast(data), size);
+			return;
+		}
+		BufferManager::GetBufferManager(*instance).GetBufferAllocator().FreeData(data_ptr_cast(data), size);
+	}
+
+	bool UnderPressure() override {
+		auto instance = db.lock();
+		if (!instance) {
+			return false;
+		}
+		auto &buffer_manager = BufferManager::GetBufferManager(*instance);
+		return double(buffer_manager.GetUsedMemory()) > double(buffer_manager.GetMaxMemory()) * MEMORY_PRESSURE_RATIO;
+	}
 
-    std::string success_msg = "Redis Target Set: " + host_str + ":" + port_str;
+	bool DatabaseOpen() const {
+		return !db.expired();
+	}
 
-    // We must use StringVector::AddString to safely allocate memory for the result string
-    result_data[0] = StringVector::AddString(result, success_msg);
+private:
+	weak_ptr<DatabaseInstance> db;
+};
+
+/*
+  Charges transport memory to db, unless another open database already pays for it.
+    - The transport (and its segment pool) is shared by every database in the process, so only one
+      of them is charged at a time: the first to load the extension, for as long as it stays open.
+    - A new allocator is only made once the charged database has closed; the old one is kept, since
+      memory it handed out is still freed through it.
+*/
+static void InstallTransportAllocator(DatabaseInstance &db) {
+	static std::mutex lock;
+	static DuckDBTransportAllocator *installed = nullptr;
+	std::lock_guard<std::mutex> guard(lock);
+	if (installed && installed->DatabaseOpen()) {
+		return;
+	}
+	installed = new DuckDBTransportAllocator(db);
+	TransportMemory::Instance().Install(installed);
+}
+
+// -------------------------------------------------------------------------------------------------
+//  redis_get('key' [, 'type']) / redis_get_blob('key') scalar functions
+// -------------------------------------------------------------------------------------------------
+
+// Values of at least this many bytes skip the receive segments (see redis_large_value_threshold).
+constexpr idx_t DEFAULT_LARGE_VALUE_THRESHOLD = 256 * 1024;
+
+// How value bytes are returned. Strings are handed out zero-copy; numbers and JSON are decoded in place.
+enum class RedisValueType : uint8_t { VARCHAR, BLOB, BIGINT, DOUBLE, JSON };
+
+struct RedisValueFormat {
+	RedisValueType type = RedisValueType::VARCHAR;
+	// Streaming threshold for string values (see redis_large_value_threshold); 0 disables.
+	idx_t large_value_threshold = DEFAULT_LARGE_VALUE_THRESHOLD;
+	// Malformed BIGINT/DOUBLE/JSON values become NULL instead of raising an error.
+	bool malformed_as_null = false;
+	// LZ4/zstd framed values are decompressed before they are decoded (see redis_compression).
+	ValueCompression compression = ValueCompression::NONE;
+	// Frames that decompress to more bytes than this (the memory limit) are treated as corrupt.
+	idx_t max_decompressed_size = NumericLimits<uint32_t>::Maximum();
+
+	bool IsString() const {
+		return type == RedisValueType::VARCHAR || type == RedisValueType::BLOB || type == RedisValueType::JSON;
+	}
+
+	bool operator==(const RedisValueFormat &other) const {
+		return type == other.type && large_value_threshold == other.large_value_threshold &&
+		       malformed_as_null == other.malformed_as_null && compression == other.compression &&
+		       max_decompressed_size == other.max_decompressed_size;
+	}
+};
+
+static RedisValueType ParseValueType(const std::string &name) {
+	auto type = StringUtil::Lower(name);
+	if (type == "varchar") {
+		return RedisValueType::VARCHAR;
+	} else if (type == "blob") {
+		return RedisValueType::BLOB;
+	} else if (type == "bigint") {
+		return RedisValueType::BIGINT;
+	} else if (type == "double") {
+		return RedisValueType::DOUBLE;
+	} else if (type == "json") {
+		return RedisValueType::JSON;
+	}
+	throw InvalidInputException("Unsupported Redis value type '%s' (expected varchar, blob, bigint, double or json)",
+	                            name);
+}
+
+static ValueCompression ParseCompression(const std::string &name) {
+	auto compression = StringUtil::Lower(name);
+	if (compression == "none" || compression.empty()) {
+		return ValueCompression::NONE;
+	} else if (compression == "auto") {
+		return ValueCompression::AUTO;
+	} else if (compression == "lz4") {
+		return ValueCompression::LZ4;
+	} else if (compression == "zstd") {
+		return ValueCompression::ZSTD;
+	}
+	throw InvalidInputException("Unsupported Redis value compression '%s' (expected none, auto, lz4 or zstd)", name);
+}
+
+static LogicalType ValueLogicalType(RedisValueType type) {
+	switch (type) {
+	case RedisValueType::BLOB:
+		return LogicalType::BLOB;
+	case RedisValueType::BIGINT:
+		return LogicalType::BIGINT;
+	case RedisValueType::DOUBLE:
+		return LogicalType::DOUBLE;
+	case RedisValueType::JSON:
+		return LogicalType::JSON();
+	default:
+		return LogicalType::VARCHAR;
+	}
+}
+
+static RedisValueFormat ValueFormat(ClientContext &context, RedisValueType type) {
+	RedisValueFormat format;
+	format.type = type;
+	Value setting;
+	if (context.TryGetCurrentSetting("redis_large_value_threshold", setting) && !setting.IsNull()) {
+		format.large_value_threshold = setting.GetValue<uint64_t>();
+	}
+	if (context.TryGetCurrentSetting("redis_malformed_values_as_null", setting) && !setting.IsNull()) {
+		format.malformed_as_null = BooleanValue::Get(setting);
+	}
+	if (context.TryGetCurrentSetting("redis_compression", setting) && !setting.IsNull()) {
+		format.compression = ParseCompression(setting.ToString());
+	}
+	format.max_decompressed_size =
+	    MinValue<idx_t>(format.max_decompressed_size, BufferManager::GetBufferManager(context).GetMaxMemory());
+	return format;
+}
+
+struct RedisGetBindData : public FunctionData {
+	RedisValueFormat format;
+	RedisRouteRef route;
+
+	RedisGetBindData(RedisValueFormat format_p, RedisRouteRef route_p) : format(format_p), route(std::move(route_p)) {
+	}
+
+	unique_ptr<FunctionData> Copy() const override {
+		return make_uniq<RedisGetBindData>(format, route);
+	}
+
+	bool Equals(const FunctionData &other_p) const override {
+		auto &other = other_p.Cast<RedisGetBindData>();
+		return format == other.format;
+	}
+};
+
+// The read policy (timeout, retries, hedging) of this session.
+static ReadPolicy ResolveReadPolicy(ClientContext &context) {
+	ReadPolicy policy;
+	Value setting;
+	if (context.TryGetCurrentSetting("redis_request_timeout_ms", setting) && !setting.IsNull()) {
+		policy.timeout_ms = MaxValue<int64_t>(0, setting.GetValue<int64_t>());
+	}
+	if (context.TryGetCurrentSetting("redis_read_retries", setting) && !setting.IsNull()) {
+		policy.retries = MaxValue<int64_t>(0, setting.GetValue<int64_t>());
+	}
+	if (context.TryGetCurrentSetting("redis_hedge_reads", setting) && !setting.IsNull()) {
+		policy.hedge = BooleanValue::Get(setting);
+	}
+	return policy;
+}
+
+/*
+  The route of a query that binds now: redis_replicas, redis_max_replica_lag_bytes and the read policy
+  of this session. Nothing is changed for other sessions.
+*/
+static RedisRouteRef ResolveRoute(ClientContext &context) {
+	int64_t max_lag_bytes = DEFAULT_MAX_REPLICA_LAG_BYTES;
+	Value setting;
+	if (context.TryGetCurrentSetting("redis_max_replica_lag_bytes", setting) && !setting.IsNull()) {
+		max_lag_bytes = setting.GetValue<int64_t>();
+	}
+	std::vector<RedisEndpoint> replicas;
+	if (context.TryGetCurrentSetting("redis_replicas", setting) && !setting.IsNull()) {
+		auto text = setting.ToString();
+		try {
+			replicas = text == "auto" ? redis_router.DiscoverReplicas() : ParseEndpointList(text);
+		} catch (std::invalid_argument &ex) {
+			throw InvalidInputException("redis_replicas: %s", ex.what());
+		} catch (std::runtime_error &ex) {
+			throw IOException("redis_replicas: %s", ex.what());
+		}
+	}
+	return redis_router.Route(replicas, max_lag_bytes, ResolveReadPolicy(context));
+}
+
+static unique_ptr<FunctionData> RedisGetBind(ClientContext &context, ScalarFunction &bound_function,
+                                             vector<unique_ptr<Expression>> &arguments) {
+	auto type = bound_function.return_type.id() == LogicalTypeId::BLOB ? RedisValueType::BLOB : RedisValueType::VARCHAR;
+	if (arguments.size() == 2) {
+		// redis_get(key, 'bigint'): the type decides the return type, so it has to be known while binding.
+		if (!arguments[1]->IsFoldable()) {
+			throw InvalidInputException("redis_get(key, type): type must be a constant");
+		}
+		auto type_value = ExpressionExecutor::EvaluateScalar(context, *arguments[1]);
+		if (type_value.IsNull()) {
+			throw InvalidInputException("redis_get(key, type): type cannot be NULL");
+		}
+		type = ParseValueType(type_value.ToString());
+		bound_function.return_type = ValueLogicalType(type);
+	}
+	return make_uniq<RedisGetBindData>(ValueFormat(context, type), ResolveRoute(context));
+}
+
+// Receives large values straight into their final string_t in the result vector's heap.
+class ResultVectorSink : public LargeValueSink {
+public:
+	ResultVectorSink(Vector &result_p, const std::vector<idx_t> &rows_p)
+	    : result(result_p), rows(rows_p), streamed(rows_p.size(), false) {
+	}
+
+	char *Allocate(size_t index, size_t len) override {
+		auto &target = FlatVector::GetData<string_t>(result)[rows[index]];
+		target = StringVector::EmptyString(result, len);
+		streamed[index] = true;
+		return target.GetDataWriteable();
+	}
+
+	void Finish(size_t index) override {
+		FlatVector::GetData<string_t>(result)[rows[index]].Finalize();
+	}
+
+	bool Streamed(idx_t index) const {
+		return streamed[index];
+	}
+
+	// Forgets streamed values before the pipeline is read again from another connection.
+	void Reset() {
+		std::fill(streamed.begin(), streamed.end(), false);
+	}
+
+private:
+	Vector &result;
+	const std::vector<idx_t> &rows;
+	std::vector<bool> streamed;
+};
+
+/*
+  Decodes one value into row of a flat result vector of the format's type.
+    - Numbers are parsed straight from the receive segments: canonical integers with the SWAR
+      parser, everything else with the rules of CAST.
+    - Returns false if the bytes are not a valid value of that type.
+*/
+static bool DecodeValue(std::string_view bytes, Vector &result, idx_t row, RedisValueType type) {
+	switch (type) {
+	case RedisValueType::BIGINT: {
+		auto &target = FlatVector::GetData<int64_t>(result)[row];
+		return ParseDecimalInt64(bytes, target) || TryCast::Operation(SegmentString(bytes), target, true);
+	}
+	case RedisValueType::DOUBLE:
+		return TryCast::Operation(SegmentString(bytes), FlatVector::GetData<double>(result)[row], true);
+	case RedisValueType::JSON:
+		if (!IsValidJson(bytes)) {
+			return false;
+		}
+		FlatVector::GetData<string_t>(result)[row] = SegmentString(bytes);
+		return true;
+	default:
+		// Values are not copied: the result vector pins the receive segments instead.
+		FlatVector::GetData<string_t>(result)[row] = SegmentString(bytes);
+		return true;
+	}
+}
+
+/*
+  Decompresses one LZ4/zstd frame and returns the plain bytes.
+    - String results are decompressed straight into the result vector's heap and stored in row.
+    - Other types go through a per-thread scratch buffer and still have to be decoded.
+    - Returns false for corrupt frames, and for frames that would decompress to more than max_size bytes:
+      the size in the header is checked before anything is allocated.
+*/
+static bool DecompressValue(std::string_view frame, ValueCompression codec, Vector &result, idx_t row,
+                            bool is_string, idx_t max_size, std::string_view &bytes) {
+	thread_local std::string scratch;
+	auto size = FrameContentSize(frame, codec);
+	if (size > 0 && static_cast<idx_t>(size) > max_size) {
+		return false;
+	}
+	if (is_string && size >= 0) {
+		auto target = StringVector::EmptyString(result, static_cast<idx_t>(size));
+		if (!DecompressFrame(frame, codec, target.GetDataWriteable(), static_cast<size_t>(size))) {
+			return false;
+		}
+		target.Finalize();
+		FlatVector::GetData<string_t>(result)[row] = target;
+		bytes = std::string_view(target.GetData(), target.GetSize());
+		return true;
+	}
+	if (!DecompressFrame(frame, codec, scratch, max_size)) {
+		return false;
+	}
+	if (is_string) {
+		auto &target = FlatVector::GetData<string_t>(result)[row];
+		target = StringVector::AddStringOrBlob(result, scratch);
+		bytes = std::string_view(target.GetData(), target.GetSize());
+	} else {
+		bytes = scratch;
+	}
+	return true;
+}
+
+// Leases a connection to node that applies the current request deadline.
+static unique_ptr<PooledClient> LeaseClient(const RedisNodeRef &node, const ReadPolicy &policy) {
+	auto client = make_uniq<PooledClient>(node->pool);
+	(*client)->request_timeout_ms = policy.timeout_ms;
+	return client;
+}
+
+/*
+  Pipelines one GET per key and writes the replies into 'rows' of a flat vector of format.type.
+    - The keys are split over the primary/replicas by the router; every server gets its pipeline
+      before any reply is read, so they work on their shares at the same time.
+    - GETs are idempotent: a share whose server fails or misses the request deadline is sent again to
+      another node, up to policy.retries times.
+    - With hedging, a share still unanswered after its server's p95 round trip is also sent to a
+      second node (or connection); whichever answers first is read, the other connection is dropped.
+    - Small string values point into the clients' receive segments, which the vector pins.
+    - String values of at least large_value_threshold bytes are streamed straight into the vector's heap.
+    - LZ4/zstd framed values are decompressed first when format.compression allows it.
+    - Missing keys become NULL; so do keys of the wrong type when wrong_type_as_null is set, and
+      malformed (or corrupt compressed) values when the format says so.
+*/
+static void FetchValuesInto(const RedisRoute &route, const std::vector<std::string_view> &keys,
+                            const std::vector<idx_t> &rows, Vector &result, const RedisValueFormat &format,
+                            bool wrong_type_as_null, const char *function_name) {
+	if (keys.empty()) {
+		return;
+	}
+	auto &result_validity = FlatVector::Validity(result);
+	auto &policy = route.policy;
+
+	// One contiguous slice of the keys per server.
+	struct ReadShare {
+		// the node the router assigned the share to (in flight accounting)
+		RedisNodeRef node;
+		idx_t offset;
+		idx_t count;
+		// where the pipeline currently is: the assigned node, or another one after a retry
+		RedisNodeRef source;
+		unique_ptr<PooledClient> client;
+		// a second copy of the pipeline once the share has been hedged
+		RedisNodeRef hedge_source;
+		unique_ptr<PooledClient> hedge;
+		RespParser parser;
+		bool finished = false;
+		// When the wait for this share began: its (re)send, or the moment reading it started if that was later.
+		// Shares are read one after the other, so time spent on earlier shares does not count against this one.
+		std::chrono::steady_clock::time_point since;
+
+		std::vector<std::string_view> Keys(const std::vector<std::string_view> &all) const {
+			return std::vector<std::string_view>(all.begin() + offset, all.begin() + offset + count);
+		}
+	};
+	std::vector<ReadShare> shares;
+	idx_t offset = 0;
+	for (auto &split : redis_router.SplitReads(route, keys.size())) {
+		shares.push_back(ReadShare {split.first, offset, split.second, split.first});
+		offset += split.second;
+	}
+
+	// Sends the share to 'source', moving on to other nodes while sends fail; returns false when out of retries.
+	auto send_share = [&](ReadShare &share, RedisNodeRef source, int64_t &retries_left, std::string &error) {
+		for (;;) {
+			try {
+				share.client = LeaseClient(source, policy);
+				share.source = source;
+				(*share.client)->SendGetPipeline(share.Keys(keys));
+				share.since = std::chrono::steady_clock::now();
+				return true;
+			} catch (Exception &) {
+				// out of memory and other DuckDB errors are not a failed server: nothing to retry
+				throw;
+			} catch (std::runtime_error &ex) {
+				redis_router.MarkFailed(source);
+				error = ex.what();
+				if (retries_left-- <= 0) {
+					return false;
+				}
+				source = redis_router.PickAlternative(route, source);
+			}
+		}
+	};
+
+	try {
+		std::vector<int64_t> retries_left(shares.size(), policy.retries);
+		std::string error;
+		for (idx_t i = 0; i < shares.size(); i++) {
+			if (!send_share(shares[i], shares[i].node, retries_left[i], error)) {
+				throw IOException("%s: %s", function_name, error);
+			}
+		}
+
+		for (idx_t share_idx = 0; share_idx < shares.size(); share_idx++) {
+			auto &share = shares[share_idx];
+			std::vector<idx_t> share_rows(rows.begin() + share.offset, rows.begin() + share.offset + share.count);
+			share.since = std::chrono::steady_clock::now();
+
+			// A threshold of 0 turns streaming off; numbers are never large enough to be worth it.
+			ResultVectorSink sink(result, share_rows);
+			auto threshold = format.IsString() ? format.large_value_threshold : 0;
+			LargeValueSink *sink_ptr = threshold > 0 ? &sink : nullptr;
+
+			RedisClient *source = nullptr;
+			const RespTape *replies;
+			for (;;) {
+				RedisNodeRef failed = share.source;
+				try {
+					source = &**share.client;
+					double delay = policy.hedge && !share.hedge ? redis_router.HedgeDelay(share.source) : -1;
+					if (delay >= 0) {
+						auto waited =
+						    std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - share.since);
+						if (!source->WaitReadable(static_cast<int>(MaxValue<double>(0, delay - waited.count())))) {
+							share.hedge_source = redis_router.PickAlternative(route, share.source);
+							try {
+								share.hedge = LeaseClient(share.hedge_source, policy);
+								(*share.hedge)->SendGetPipeline(share.Keys(keys));
+							} catch (Exception &) {
+								throw;
+							} catch (std::runtime_error &) {
+								// no second copy then; keep waiting for the first
+								redis_router.MarkFailed(share.hedge_source);
+								share.hedge.reset();
+							}
+						}
+						if (share.hedge) {
+							RedisClient *racing[] = {source, &**share.hedge};
+							int timeout = policy.timeout_ms > 0 ? static_cast<int>(policy.timeout_ms) : -1;
+							if (RedisClient::WaitAnyReadable(racing, 2, timeout) == 1) {
+								// the hedge answered first; the original connection has unread replies and is dropped
+								failed = share.hedge_source;
+								std::swap(share.client, share.hedge);
+								std::swap(share.source, share.hedge_source);
+								source = &**share.client;
+							}
+						}
+					}
+					replies = &source->ReadGetPipeline(share.count, share.parser, sink_ptr, threshold);
+					break;
+				} catch (Exception &) {
+					throw;
+				} catch (std::runtime_error &ex) {
+					redis_router.MarkFailed(failed);
+					if (retries_left[share_idx]-- <= 0) {
+						throw IOException("%s: %s", function_name, ex.what());
+					}
+					// start over on another connection: partially streamed values are written again
+					share.parser.ClearObjects();
+					share.hedge.reset();
+					sink.Reset();
+					if (!send_share(share, redis_router.PickAlternative(route, failed), retries_left[share_idx], error)) {
+						throw IOException("%s: %s", function_name, error);
+					}
+				}
+			}
+			// a hedged node gets the time until the hedge answered: a lower bound of its own round trip
+			auto elapsed = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - share.since);
+			bool measured = share.source == share.node || share.hedge_source == share.node;
+			redis_router.FinishReads(share.node, share.count, measured ? elapsed.count() : -1);
+			share.finished = true;
+			share.hedge.reset();
+
+			for (idx_t i = 0; i < share.count; i++) {
+				const RespObject &reply = (*replies)[i];
+				auto row = share_rows[i];
+				std::string_view bytes = reply.AsString();
+				// the bytes already live in the result vector (streamed or decompressed)
+				bool in_place = sink.Streamed(i);
+				if (in_place) {
+					auto &value = FlatVector::GetData<string_t>(result)[row];
+					bytes = std::string_view(value.GetData(), value.GetSize());
+				} else if (reply.type == RespType::NULL_VAL) {
+					result_validity.SetInvalid(row);
+					continue;
+				} else if (reply.type == RespType::ERROR) {
+					if (wrong_type_as_null && bytes.substr(0, 9) == "WRONGTYPE") {
+						result_validity.SetInvalid(row);
+						continue;
+					}
+					throw InvalidInputException("%s: %s", function_name, std::string(bytes));
+				}
+
+				auto codec = DetectCompression(bytes, format.compression);
+				bool valid = true;
+				if (codec != ValueCompression::NONE) {
+					valid = DecompressValue(bytes, codec, result, row, format.IsString(), format.max_decompressed_size,
+					                        bytes);
+					in_place = format.IsString();
+				}
+				if (valid) {
+					// in place strings only still need a look if they are supposed to be JSON
+					valid = in_place ? format.type != RedisValueType::JSON || IsValidJson(bytes)
+					                 : DecodeValue(bytes, result, row, format.type);
+				}
+				if (valid) {
+					continue;
+				}
+
+				if (!format.malformed_as_null) {
+					throw ConversionException("%s: value of key '%s' is not a valid %s", function_name,
+					                          std::string(keys[share.offset + i]),
+					                          ValueLogicalType(format.type).ToString());
+				}
+				result_validity.SetInvalid(row);
+			}
+			if (format.IsString()) {
+				StringVector::AddBuffer(result, make_buffer<RedisSegmentBuffer>(source->ReceiveSegments()));
+			}
+			share.parser.ClearObjects();
+			source->ClearBuffer();
+		}
+	} catch (...) {
+		// Release the in-flight accounting of shares that never completed; their clients have unread
+		// replies and are closed by the pool instead of being reused.
+		for (auto &share : shares) {
+			if (!share.finished) {
+				redis_router.FinishReads(share.node, share.count, -1);
+			}
+		}
+		throw;
+	}
+}
+
+inline void GetKeyScalarFun(DataChunk &args, ExpressionState &state, Vector &result) {
+	auto &func_expr = state.expr.Cast<BoundFunctionExpression>();
+	auto &bind_data = func_expr.bind_info->Cast<RedisGetBindData>();
+	auto &input_vector = args.data[0];
+	bool is_constant = input_vector.GetVectorType() == VectorType::CONSTANT_VECTOR;
+	// A constant key only needs a single round trip for the whole chunk.
+	idx_t count = is_constant ? 1 : args.size();
+
+	UnifiedVectorFormat input_format;
+	input_vector.ToUnifiedFormat(count, input_format);
+	auto input_data = UnifiedVectorFormat::GetData<string_t>(input_format);
+
+	result.SetVectorType(VectorType::FLAT_VECTOR);
+	auto &result_validity = FlatVector::Validity(result);
+
+	// Collect the non-NULL keys of the chunk so they can be sent as one pipeline.
+	std::vector<std::string_view> keys;
+	std::vector<idx_t> rows;
+	keys.reserve(count);
+	rows.reserve(count);
+	for (idx_t i = 0; i < count; i++) {
+		auto idx = input_format.sel->get_index(i);
+		if (!input_format.validity.RowIsValid(idx)) {
+			result_validity.SetInvalid(i);
+			continue;
+		}
+		keys.emplace_back(input_data[idx].GetData(), input_data[idx].GetSize());
+		rows.push_back(i);
+	}
+
+	FetchValuesInto(*bind_data.route, keys, rows, result, bind_data.format, false, "redis_get");
+
+	if (is_constant) {
+		result.SetVectorType(VectorType::CONSTANT_VECTOR);
+	}
 }
+
+
 // -------------------------------------------------------------------------------------------------
-//  redis_scan(pattern) table function
+//  redis_scan(pattern) / redis_kv(pattern) table functions
 // -------------------------------------------------------------------------------------------------
 
 
 struct RedisScanBindData : public FunctionData {
 	std::string pattern;
+	// redis_kv: also GET the value of every key (second column)
+	bool with_values = false;
+	RedisValueFormat value_format;
+	// TABLESAMPLE pushed into the scan (see RedisSamplePushdown): share of the keyspace to read, or -1
+	double sample_fraction = -1;
+	uint64_t sample_seed = 0;
+	// redis_hash_scan: the hash fields behind columns 1..n
+	vector<string> hash_fields;
+	// estimated_keys := N (set by the views of an attached Redis), or -1 when unknown
+	int64_t estimated_keys = -1;
+	// servers and read policy of the session that bound the scan
+	RedisRouteRef route;
 
 	explicit RedisScanBindData(std::string pattern_p) : pattern(std::move(pattern_p)) {}
 
+	bool Sampled() const {
+		return sample_fraction >= 0;
+	}
+
 	unique_ptr<FunctionData> Copy() const override {
 		// Bind data must be copyable because DuckDB may duplicate plans.
-		return make_uniq<RedisScanBindData>(pattern);
+		auto result = make_uniq<RedisScanBindData>(pattern);
+		result->with_values = with_values;
+		result->value_format = value_format;
+		result->sample_fraction = sample_fraction;
+		result->sample_seed = sample_seed;
+		result->hash_fields = hash_fields;
+		result->estimated_keys = estimated_keys;
+		result->route = route;
+		return std::move(result);
 	}
 
 	bool Equals(const FunctionData &other_p) const override {
 		auto &other = other_p.Cast<RedisScanBindData>();
-		return pattern == other.pattern;
+		return pattern == other.pattern && with_values == other.with_values &&
+		       value_format == other.value_format && sample_fraction == other.sample_fraction &&
+		       sample_seed == other.sample_seed && hash_fields == other.hash_fields &&
+		       estimated_keys == other.estimated_keys;
 	}
 };
 
 struct RedisScanGlobalState : public GlobalTableFunctionState {
+	// A scan stays on one server: SCAN cursors are only meaningful to the node that produced them.
+	RedisRouteRef route;
+	RedisNodeRef node;
+	unique_ptr<PooledClient> client;
+
 	std::string cursor = "0";
 	bool done = false;
+	// Sampled scans jump between slices of the cursor space instead of walking all of it.
+	unique_ptr<ScanSampler> sampler;
 
-	std::vector<std::string> batch_keys;
+	// Views into the receive segments of the current SCAN page, pinned by batch_segments.
+	std::vector<std::string_view> batch_keys;
+	buffer_ptr<RedisSegmentBuffer> batch_segments;
 	idx_t batch_pos = 0; // next index inside batch_keys to output
 
 
-	// Parser object is kept here so we can reuse allocations.
+	// Parser and encoder are kept here so we can reuse allocations.
 	RespParser parser;
+	RespEncoder encoder;
+
+	/*
+	  The SCAN cursor, its client and the current batch are shared: threads take chunks of keys under this lock.
+	  redis_kv then fetches, decompresses and decodes the values of its chunk in parallel, on its own leased
+	  clients. A plain key scan has nothing to parallelize and stays single-threaded.
+	*/
+	std::mutex lock;
+	idx_t max_threads = 1;
+
+	// Which column (key_name, value or a metadata column) every output vector holds.
+	vector<column_t> column_ids;
 
-	// Force single-threaded scan:
-	// This global state and the RedisClient socket/buffer are not safe for parallel scan threads.
 	idx_t MaxThreads() const override {
-		return 1;
+		return max_threads;
 	}
 
 	~RedisScanGlobalState() override {
 		// On query end, it's safe to release all parsed objects and reuse the buffer.
 		// (DuckDB will not call us anymore after destruction.)
 		parser.ClearObjects();
-		ScanClient.ClearBuffer();
+		if (client) {
+			(*client)->ClearBuffer();
+		}
 	}
 };
 
-static void FetchNextBatch(RedisScanGlobalState &state, const std::string &pattern) {
+// Keys to ask SCAN for: the sampler's hint, and less while memory is scarce.
+static size_t ScanPageCount(RedisScanGlobalState &state) {
+	size_t count = state.sampler ? state.sampler->Count() : ScanSampler::MAX_COUNT;
+	if (TransportMemory::Instance().UnderPressure()) {
+		count = MinValue<size_t>(count, PRESSURE_SCAN_COUNT);
+	}
+	return count;
+}
+
+/*
+  Sends SCAN <cursor> and reads its reply into state.parser.
+    - A failed or timed out page is sent again on a new connection to the same node, up to policy.retries
+      times: the cursor only advances once a reply has been parsed, so the scan resumes where it was.
+    - Cursors belong to the node that produced them, so a scan never moves to another node.
+*/
+static void ReadScanPage(RedisScanGlobalState &state, const std::string &pattern) {
+	auto &policy = state.route->policy;
+	for (int64_t attempt = 0;; attempt++) {
+		std::string error;
+		try {
+			if (!state.client) {
+				state.client = LeaseClient(state.node, policy);
+			}
+			auto &client = **state.client;
+			state.encoder.EncodeScan(state.cursor, pattern, ScanPageCount(state));
+			if (!client.SendEncoded(state.encoder)) {
+				error = "send to " + state.node->endpoint.ToString() + " failed";
+			} else {
+				client.CheckedReadResponse(state.parser);
+				return;
+			}
+		} catch (Exception &) {
+			throw;
+		} catch (std::runtime_error &ex) {
+			error = ex.what();
+		}
+		redis_router.MarkFailed(state.node);
+		state.encoder.Clear();
+		state.parser.ClearObjects();
+		// the broken connection is closed by the pool; the next attempt connects again
+		state.client.reset();
+		if (attempt >= policy.retries) {
+			throw IOException("redis_scan: %s", error);
+		}
+	}
+}
 
+static void FetchNextBatch(RedisScanGlobalState &state, const std::string &pattern) {
 	state.batch_keys.clear();
 	state.batch_pos = 0;
 
 	state.parser.ClearObjects();
-	ScanClient.ClearBuffer();
+	if (state.client) {
+		(*state.client)->ClearBuffer();
+	}
 
 	for (;;) {
-		std::string cmd = state.parser.BuildScan(state.cursor, pattern);
-
-		if (!ScanClient.CheckedSend(cmd)) {
-			throw InvalidInputException("redis_scan: send failed");
-		}
-
-		ScanClient.CheckedReadResponse(state.parser);
+		ReadScanPage(state, pattern);
+		auto &client = **state.client;
 
 		// Get parsed objects (your API returns by value; fine for now).
 		auto objects = state.parser.GetObjects();
@@ -195,24 +927,32 @@ static void FetchNextBatch(RedisScanGlobalState &state, const std::string &patte
 		const RespObject &keys_obj = reply.children[1];
 
 		std::string_view next_cursor_view = cursor_obj.AsString();
-		state.cursor.assign(next_cursor_view.data(), next_cursor_view.size());
 
 		if (keys_obj.type == RespType::ARRAY) {
 			for (const auto &child : keys_obj.children) {
-				auto sv = child.AsString();
-				state.batch_keys.emplace_back(sv.data(), sv.size());
+				state.batch_keys.push_back(child.AsString());
 			}
 		} else {
 			throw InvalidInputException("redis_scan: keys element was not an array");
 		}
 
-		// SCAN is complete when cursor is "0"
-		if (state.cursor == "0") {
-			state.done = true;
+		if (state.sampler) {
+			// the sampler decides where the next page starts (possibly a later slice)
+			state.sampler->Advance(next_cursor_view);
+			state.cursor = state.sampler->Cursor();
+			state.done = state.sampler->Done();
+		} else {
+			state.cursor.assign(next_cursor_view.data(), next_cursor_view.size());
+			// SCAN is complete when cursor is "0"
+			state.done = state.cursor == "0";
 		}
 
 		// If we got keys, great — we can return them.
+		// The keys keep their segments alive, so the client is free to reuse its chain right away.
 		if (!state.batch_keys.empty()) {
+			state.batch_segments = make_buffer<RedisSegmentBuffer>(client.ReceiveSegments());
+			state.parser.ClearObjects();
+			client.ClearBuffer();
 			return;
 		}
 
@@ -223,142 +963,3163 @@ static void FetchNextBatch(RedisScanGlobalState &state, const std::string &patte
 
 		// Otherwise: no keys but still not done, so reuse memory and try next cursor.
 		state.parser.ClearObjects();
-		ScanClient.ClearBuffer();
+		client.ClearBuffer();
 	}
 }
 
-unique_ptr<FunctionData> RedisScanBind(
-    ClientContext &,
-    TableFunctionBindInput &input,
-    vector<LogicalType> &return_types,
-    vector<string> &names
-) {
-	if (input.inputs.size() != 1) {
-		throw InvalidInputException("redis_scan(pattern) expects exactly 1 argument");
-	}
-	if (input.inputs[0].IsNull()) {
-		throw InvalidInputException("redis_scan(pattern) pattern cannot be NULL");
-	}
-	auto pattern = input.inputs[0].GetValue<std::string>();
+// -------------------------------------------------------------------------------------------------
+//  redis_scan metadata columns: TYPE, PTTL, OBJECT ENCODING, MEMORY USAGE, OBJECT IDLETIME per key
+// -------------------------------------------------------------------------------------------------
 
-	// Output schema: one VARCHAR column called key_name
-	return_types.push_back(LogicalType::VARCHAR);
-	names.push_back("key_name");
+struct RedisMetadataColumn {
+	const char *name;
+	LogicalTypeId type;
+	// pre-encoded command, followed by the key
+	std::string_view command;
+};
 
-	return make_uniq<RedisScanBindData>(std::move(pattern));
-}
+/*
+  Virtual columns of redis_scan: not part of SELECT *, only fetched when a query names them.
+    - Column i has id VIRTUAL_COLUMN_START + i.
+    - type is NULL for keys deleted during the scan, ttl_ms for keys without an expiry, and idle_seconds
+      when the server tracks LFU instead of idle time.
+*/
+static const RedisMetadataColumn METADATA_COLUMNS[] = {
+    {"type", LogicalTypeId::VARCHAR, resp::TYPE_PREFIX.View()},
+    {"ttl_ms", LogicalTypeId::BIGINT, resp::PTTL_PREFIX.View()},
+    {"encoding", LogicalTypeId::VARCHAR, resp::OBJECT_ENCODING_PREFIX.View()},
+    {"memory_bytes", LogicalTypeId::BIGINT, resp::MEMORY_USAGE_PREFIX.View()},
+    {"idle_seconds", LogicalTypeId::BIGINT, resp::OBJECT_IDLETIME_PREFIX.View()},
+};
+static constexpr idx_t METADATA_COLUMN_COUNT = sizeof(METADATA_COLUMNS) / sizeof(METADATA_COLUMNS[0]);
 
-unique_ptr<GlobalTableFunctionState> RedisScanInit(ClientContext &, TableFunctionInitInput &input) {
-	auto state = make_uniq<RedisScanGlobalState>();
-	auto &bind = input.bind_data->Cast<RedisScanBindData>();
+/*
+  sample_fraction: the share of the keyspace a TABLESAMPLE pushed into the scan reads, 1.0 for a full scan.
+    - It is the share the scan's own sampler picked (rounded to whole slices, sized by the scanned node's
+      DBSIZE), so COUNT(*) / any_value(sample_fraction) estimates the full count.
+*/
+static constexpr column_t SAMPLE_FRACTION_COLUMN = VIRTUAL_COLUMN_START + METADATA_COLUMN_COUNT;
 
-	{
-		std::scoped_lock<std::mutex> lock(scan_mutex);
-		if (!ScanClient.Connect(ScanClient.host.c_str(), ScanClient.port)) {
-			throw InvalidInputException("redis_scan: not connected (redis_connect failed)");
-		}
+static virtual_column_map_t RedisScanVirtualColumns(ClientContext &, optional_ptr<FunctionData>) {
+	virtual_column_map_t result;
+	for (idx_t i = 0; i < METADATA_COLUMN_COUNT; i++) {
+		result.insert(
+		    make_pair(VIRTUAL_COLUMN_START + i, TableColumn(METADATA_COLUMNS[i].name, LogicalType(METADATA_COLUMNS[i].type))));
 	}
-
-	// Start scan at cursor "0"
-	state->cursor = "0";
-	state->done = false;
-	state->batch_keys.clear();
-	state->batch_pos = 0;
-
-	// fetch lazily in RedisScanFunc so we only hold buffer view for as long as needed for output.
-	(void)bind;
-
-	return std::move(state);
+	result.insert(make_pair(SAMPLE_FRACTION_COLUMN, TableColumn("sample_fraction", LogicalType::DOUBLE)));
+	result.insert(make_pair(COLUMN_IDENTIFIER_ROW_ID, TableColumn("rowid", LogicalType::ROW_TYPE)));
+	return result;
 }
 
-void RedisScanFunc(ClientContext &, TableFunctionInput &data_p, DataChunk &output) {
-	std::scoped_lock<std::mutex> lock(scan_mutex);
-	auto &bind = data_p.bind_data->Cast<RedisScanBindData>();
-	auto &state = data_p.global_state->Cast<RedisScanGlobalState>();
-
-	// If we are done and no buffered keys remain, end scan.
-	if (state.done && state.batch_pos >= (idx_t)state.batch_keys.size()) {
-		output.SetCardinality(0);
-		return;
+// The metadata column a column id refers to, if any.
+static optional_idx MetadataColumn(column_t column_id) {
+	if (column_id >= VIRTUAL_COLUMN_START && column_id < VIRTUAL_COLUMN_START + METADATA_COLUMN_COUNT) {
+		return optional_idx(column_id - VIRTUAL_COLUMN_START);
 	}
+	return optional_idx();
+}
 
-	// If current batch is exhausted, fetch the next batch from Redis.
-	if (state.batch_pos >= (idx_t)state.batch_keys.size()) {
-		FetchNextBatch(state, bind.pattern);
-
-		// If fetch says done and produced no keys, end scan.
-		if (state.batch_keys.empty() && state.done) {
-			output.SetCardinality(0);
+static void WriteMetadata(const RespObject &reply, idx_t metadata, Vector &result, idx_t row) {
+	auto &column = METADATA_COLUMNS[metadata];
+	if (column.type == LogicalTypeId::VARCHAR) {
+		bool is_string = reply.type == RespType::SIMPLE_STRING || reply.type == RespType::BULK_STRING;
+		// TYPE answers "none" for a key that is gone by now
+		if (!is_string || (metadata == 0 && reply.AsString() == "none")) {
+			FlatVector::SetNull(result, row, true);
 			return;
 		}
+		auto value = reply.AsString();
+		FlatVector::GetData<string_t>(result)[row] = StringVector::AddString(result, value.data(), value.size());
+		return;
 	}
-
-	// Produce up to STANDARD_VECTOR_SIZE rows from the current batch
-	idx_t remaining = (idx_t)state.batch_keys.size() - state.batch_pos;
-	idx_t count = std::min<idx_t>(STANDARD_VECTOR_SIZE, remaining);
-
-	output.SetCardinality(count);
-
-	auto &out_vector = output.data[0];
-	out_vector.SetVectorType(VectorType::FLAT_VECTOR);
-	auto out_data = FlatVector::GetData<string_t>(out_vector);
-
-	for (idx_t i = 0; i < count; i++) {
-		std::string_view key_view = state.batch_keys[state.batch_pos + i];
-		out_data[i] = StringVector::AddString(out_vector, key_view.data(), key_view.size());
+	// PTTL: -1 no expiry, -2 no key
+	if (reply.type != RespType::INT || reply.int_val < 0) {
+		FlatVector::SetNull(result, row, true);
+		return;
 	}
+	FlatVector::GetData<int64_t>(result)[row] = reply.int_val;
+}
 
-	state.batch_pos += count;
+/*
+  Sends one pipeline of command_count commands to the scan's node and hands the replies to consume.
+    - Used for lookups on the keys of a scan page, which live on that node.
+    - The lookups are read-only, so a failed pipeline is sent again on a new connection, up to policy.retries times.
+    - Errors are prefixed with 'function', the table function the lookups are for.
+*/
+template <class ENCODE, class CONSUME>
+static void PipelineOnNode(const char *function, const RedisScanGlobalState &scan, size_t command_count,
+                           ENCODE &&encode, CONSUME &&consume) {
+	auto &node = scan.node;
+	auto &policy = scan.route->policy;
+	RespEncoder encoder;
+	RespParser parser;
+	for (int64_t attempt = 0;; attempt++) {
+		std::string error;
+		try {
+			auto client = LeaseClient(node, policy);
+			encode(encoder);
+			if (!(*client)->SendEncoded(encoder)) {
+				error = "send to " + node->endpoint.ToString() + " failed";
+			} else {
+				(*client)->ReadReplies(parser, command_count);
+				consume(parser.Objects(), **client);
+				parser.ClearObjects();
+				(*client)->ClearBuffer();
+				return;
+			}
+		} catch (Exception &) {
+			throw;
+		} catch (std::runtime_error &ex) {
+			error = ex.what();
+		}
+		redis_router.MarkFailed(node);
+		encoder.Clear();
+		parser.ClearObjects();
+		if (attempt >= policy.retries) {
+			throw IOException("%s: %s", function, error);
+		}
+	}
+}
 
-	// If we finished the batch, it's now safe to reuse the Redis buffer.
-	// We must also clear batch_keys so no dangling string_views remain in state.
-	if (state.batch_pos >= (idx_t)state.batch_keys.size()) {
-		state.batch_keys.clear();
-		state.batch_pos = 0;
+/*
+  Fills the projected metadata columns for one chunk of keys.
+    - One command per key and column: TYPE, PTTL, OBJECT ENCODING, MEMORY USAGE, OBJECT IDLETIME.
+      None of them touch the keys' LRU clock.
+*/
+static void FetchMetadataInto(const RedisScanGlobalState &scan, const std::vector<std::string_view> &keys,
+                              const std::vector<std::pair<idx_t, Vector *>> &columns) {
+	if (keys.empty() || columns.empty()) {
+		return;
+	}
+	PipelineOnNode(
+	    "redis_scan", scan, keys.size() * columns.size(),
+	    [&](RespEncoder &encoder) {
+		    for (auto &key : keys) {
+			    for (auto &column : columns) {
+				    encoder.EncodeKeyCommand(METADATA_COLUMNS[column.first].command, key);
+			    }
+		    }
+	    },
+	    [&](const RespTape &replies, RedisClient &) {
+		    for (idx_t row = 0; row < keys.size(); row++) {
+			    for (idx_t c = 0; c < columns.size(); c++) {
+				    WriteMetadata(replies[row * columns.size() + c], columns[c].first, *columns[c].second, row);
+			    }
+		    }
+	    });
+}
 
-		state.parser.ClearObjects();
-		ScanClient.ClearBuffer();
+/*
+  redis_hash_scan: one HMGET per key with only the projected fields.
+    - Field values point into the receive segments, which the vectors pin.
+    - Missing fields, and keys that are not hashes, are NULL.
+*/
+static void FetchHashFieldsInto(const RedisScanGlobalState &scan, const std::vector<std::string_view> &keys,
+                                const vector<string> &fields, const std::vector<std::pair<idx_t, Vector *>> &columns) {
+	if (keys.empty() || columns.empty()) {
+		return;
 	}
+	PipelineOnNode(
+	    "redis_hash_scan", scan, keys.size(),
+	    [&](RespEncoder &encoder) {
+		    for (auto &key : keys) {
+			    encoder.AppendArrayHeader(2 + columns.size());
+			    encoder.AppendRaw(resp::HMGET_ARG.View());
+			    encoder.AppendBulk(key);
+			    for (auto &column : columns) {
+				    encoder.AppendBulk(fields[column.first]);
+			    }
+			    encoder.EndCommand();
+		    }
+	    },
+	    [&](const RespTape &replies, RedisClient &client) {
+		    for (idx_t row = 0; row < keys.size(); row++) {
+			    auto &reply = replies[row];
+			    bool is_hash = reply.type == RespType::ARRAY && reply.children.size() == columns.size();
+			    for (idx_t c = 0; c < columns.size(); c++) {
+				    auto &vector = *columns[c].second;
+				    if (!is_hash || reply.children[c].type != RespType::BULK_STRING) {
+					    FlatVector::SetNull(vector, row, true);
+					    continue;
+				    }
+				    FlatVector::GetData<string_t>(vector)[row] = SegmentString(reply.children[c].AsString());
+			    }
+		    }
+		    auto segments = make_buffer<RedisSegmentBuffer>(client.ReceiveSegments());
+		    for (auto &column : columns) {
+			    StringVector::AddBuffer(*column.second, segments);
+		    }
+	    });
 }
+
 // -------------------------------------------------------------------------------------------------
-//  redis_get('key') scalar function
+//  Parameters shared by redis_scan, redis_kv and redis_hash_scan
 // -------------------------------------------------------------------------------------------------
 
-inline void GetKeyScalarFun(DataChunk &args, ExpressionState &, Vector &result) {
-	RespParser parser;                 // ok per-call
-	auto &input_vector = args.data[0];
+// The node of the Redis attached as 'name' (see RedisCatalog); throws if there is none.
+static RedisNodeRef AttachedNode(ClientContext &context, const string &name);
 
-	UnaryExecutor::Execute<string_t, string_t>(
-	    input_vector, result, args.size(),
-	    [&](string_t key) {
-		std::string_view sv;
-		{
-		    std::scoped_lock<std::mutex> lock(get_mutex);
-		    sv = GetClient.RedisGet(key.GetString(), parser);
-		    return StringVector::AddString(result, sv.data(), sv.size());
+/*
+  endpoint := 'host:port' reads from that server instead of the redis_connect() target; the target itself
+  is left alone. attached := 'name' reads from the Redis attached under that name, which is how its views
+  reach it. estimated_keys := N is the cardinality the optimizer plans with.
+*/
+static void BindScanParameters(ClientContext &context, TableFunctionBindInput &input, RedisScanBindData &bind) {
+	RedisNodeRef node;
+	auto entry = input.named_parameters.find("attached");
+	if (entry != input.named_parameters.end() && !entry->second.IsNull()) {
+		node = AttachedNode(context, entry->second.ToString());
+	}
+	entry = input.named_parameters.find("endpoint");
+	if (!node && entry != input.named_parameters.end() && !entry->second.IsNull()) {
+		try {
+			node = redis_router.EndpointNode(ParseEndpoint(entry->second.ToString()));
+		} catch (std::invalid_argument &ex) {
+			throw InvalidInputException("Invalid Redis address (%s)", ex.what());
 		}
-	    }
-	);
+	}
+	// replicas belong to the redis_connect() target; another server is read from directly
+	bind.route = node ? redis_router.Route(node, ResolveReadPolicy(context)) : ResolveRoute(context);
+	entry = input.named_parameters.find("estimated_keys");
+	if (entry != input.named_parameters.end() && !entry->second.IsNull()) {
+		bind.estimated_keys = MaxValue<int64_t>(0, entry->second.GetValue<int64_t>());
+	}
 }
 
+static unique_ptr<NodeStatistics> RedisScanCardinality(ClientContext &, const FunctionData *bind_data) {
+	auto &bind = bind_data->Cast<RedisScanBindData>();
+	if (bind.estimated_keys < 0) {
+		return make_uniq<NodeStatistics>();
+	}
+	double keys = double(bind.estimated_keys) * (bind.Sampled() ? bind.sample_fraction : 1.0);
+	return make_uniq<NodeStatistics>(idx_t(keys));
+}
 
-// -------------------------------------------------------------------------------------------------
-//  SETUP
-// -------------------------------------------------------------------------------------------------
-static void LoadInternal(ExtensionLoader &loader) {
-	// Register a scalar function
-	auto redduck_scalar_function = ScalarFunction("redduck", {LogicalType::VARCHAR}, LogicalType::VARCHAR, RedduckScalarFun);
+unique_ptr<FunctionData> RedisScanBind(
+    ClientContext &context,
+    TableFunctionBindInput &input,
+    vector<LogicalType> &return_types,
+    vector<string> &names
+) {
+	if (input.inputs.size() != 1) {
+		throw InvalidInputException("redis_scan(pattern) expects exactly 1 argument");
+	}
+	if (input.inputs[0].IsNull()) {
+		throw InvalidInputException("redis_scan(pattern) pattern cannot be NULL");
+	}
+	auto result = make_uniq<RedisScanBindData>(input.inputs[0].GetValue<std::string>());
+	BindScanParameters(context, input, *result);
+
+	// Output schema: one VARCHAR column called key_name
+	return_types.push_back(LogicalType::VARCHAR);
+	names.push_back("key_name");
+
+	return std::move(result);
+}
+
+unique_ptr<FunctionData> RedisKvBind(
+    ClientContext &context,
+    TableFunctionBindInput &input,
+    vector<LogicalType> &return_types,
+    vector<string> &names
+) {
+	if (input.inputs.size() != 1) {
+		throw InvalidInputException("redis_kv(pattern) expects exactly 1 argument");
+	}
+	if (input.inputs[0].IsNull()) {
+		throw InvalidInputException("redis_kv(pattern) pattern cannot be NULL");
+	}
+	auto result = make_uniq<RedisScanBindData>(input.inputs[0].GetValue<std::string>());
+	BindScanParameters(context, input, *result);
+	result->with_values = true;
+	auto value_type = RedisValueType::VARCHAR;
+	auto entry = input.named_parameters.find("value_type");
+	if (entry != input.named_parameters.end() && !entry->second.IsNull()) {
+		value_type = ParseValueType(entry->second.ToString());
+	}
+	result->value_format = ValueFormat(context, value_type);
+	entry = input.named_parameters.find("compression");
+	if (entry != input.named_parameters.end() && !entry->second.IsNull()) {
+		result->value_format.compression = ParseCompression(entry->second.ToString());
+	}
+
+	// Output schema: key_name, value (NULL for keys that are not strings)
+	return_types.push_back(LogicalType::VARCHAR);
+	names.push_back("key_name");
+	return_types.push_back(ValueLogicalType(value_type));
+	names.push_back("value");
+
+	return std::move(result);
+}
+
+unique_ptr<FunctionData> RedisHashScanBind(ClientContext &context, TableFunctionBindInput &input,
+                                           vector<LogicalType> &return_types, vector<string> &names) {
+	if (input.inputs.size() != 2 || input.inputs[0].IsNull() || input.inputs[1].IsNull()) {
+		throw InvalidInputException("redis_hash_scan(pattern, fields) expects two non-NULL arguments");
+	}
+	auto result = make_uniq<RedisScanBindData>(input.inputs[0].GetValue<std::string>());
+	BindScanParameters(context, input, *result);
+
+	// Output schema: key_name, then one VARCHAR column per field
+	return_types.push_back(LogicalType::VARCHAR);
+	names.push_back("key_name");
+	for (auto &field : ListValue::GetChildren(input.inputs[1])) {
+		if (field.IsNull()) {
+			throw InvalidInputException("redis_hash_scan: field names cannot be NULL");
+		}
+		result->hash_fields.push_back(field.ToString());
+		return_types.push_back(LogicalType::VARCHAR);
+		names.push_back(result->hash_fields.back());
+	}
+	if (result->hash_fields.empty()) {
+		throw InvalidInputException("redis_hash_scan: expected at least one field");
+	}
+	return std::move(result);
+}
+
+unique_ptr<GlobalTableFunctionState> RedisScanInit(ClientContext &context, TableFunctionInitInput &input) {
+	auto state = make_uniq<RedisScanGlobalState>();
+	auto &bind = input.bind_data->Cast<RedisScanBindData>();
+
+	state->route = bind.route;
+	state->node = redis_router.PickScanNode(*state->route);
+	try {
+		state->client = LeaseClient(state->node, state->route->policy);
+	} catch (std::runtime_error &ex) {
+		redis_router.MarkFailed(state->node);
+		throw IOException("redis_scan: %s", ex.what());
+	}
+
+	state->column_ids = input.column_ids;
+	// metadata and hash fields are looked up per chunk, like redis_kv values
+	bool with_lookups = false;
+	for (auto column_id : state->column_ids) {
+		with_lookups |= MetadataColumn(column_id).IsValid() ||
+		                (column_id >= 1 && column_id <= bind.hash_fields.size());
+	}
+
+	// Start scan at cursor "0"
+	state->cursor = "0";
+	state->done = false;
+	state->batch_keys.clear();
+	state->batch_pos = 0;
+
+	if (bind.Sampled()) {
+		// the table size (about DBSIZE buckets) decides how finely the cursor space can be sliced
+		int64_t key_count;
+		try {
+			const RespObject &reply = (*state->client)->RunCommand({"DBSIZE"}, state->parser);
+			key_count = reply.type == RespType::INT ? reply.int_val : 0;
+		} catch (std::runtime_error &ex) {
+			redis_router.MarkFailed(state->node);
+			throw IOException("redis_scan: %s", ex.what());
+		}
+		state->parser.ClearObjects();
+		(*state->client)->ClearBuffer();
+		state->sampler = make_uniq<ScanSampler>(bind.sample_fraction, bind.sample_seed, MaxValue<int64_t>(key_count, 0));
+		state->cursor = state->sampler->Cursor();
+		state->done = state->sampler->Done();
+	}
+
+	// fetch lazily in RedisScanFunc so we only hold buffer view for as long as needed for output.
+	// every thread keeps a chunk of values in flight, so do not fan out while memory is scarce
+	if ((bind.with_values || with_lookups) && !TransportMemory::Instance().UnderPressure()) {
+		state->max_threads = MaxValue<idx_t>(1, TaskScheduler::GetScheduler(context).NumberOfThreads());
+	}
+
+	return std::move(state);
+}
+
+void RedisScanFunc(ClientContext &, TableFunctionInput &data_p, DataChunk &output) {
+	auto &bind = data_p.bind_data->Cast<RedisScanBindData>();
+	auto &state = data_p.global_state->Cast<RedisScanGlobalState>();
+
+	// Take the next chunk of keys; the views stay valid through the segments pinned with them.
+	std::vector<std::string_view> keys;
+	buffer_ptr<RedisSegmentBuffer> segments;
+	{
+		std::lock_guard<std::mutex> guard(state.lock);
+
+		// If current batch is exhausted, fetch the next batch from Redis.
+		if (state.batch_pos >= (idx_t)state.batch_keys.size()) {
+			// If we are done and no buffered keys remain, end scan.
+			if (state.done) {
+				output.SetCardinality(0);
+				return;
+			}
+			FetchNextBatch(state, bind.pattern);
+
+			// If fetch says done and produced no keys, end scan.
+			if (state.batch_keys.empty()) {
+				output.SetCardinality(0);
+				return;
+			}
+		}
+
+		// Produce up to STANDARD_VECTOR_SIZE rows from the current batch
+		idx_t remaining = (idx_t)state.batch_keys.size() - state.batch_pos;
+		idx_t take = std::min<idx_t>(STANDARD_VECTOR_SIZE, remaining);
+		keys.assign(state.batch_keys.begin() + state.batch_pos, state.batch_keys.begin() + state.batch_pos + take);
+		segments = state.batch_segments;
+		state.batch_pos += take;
+
+		// If we finished the batch, drop our pin; output vectors keep the segments alive as long as they need them.
+		if (state.batch_pos >= (idx_t)state.batch_keys.size()) {
+			state.batch_keys.clear();
+			state.batch_segments.reset();
+			state.batch_pos = 0;
+		}
+	}
+
+	idx_t count = keys.size();
+	output.SetCardinality(count);
+
+	// Only projected columns are produced: values, fields and metadata are not fetched for a key-only query.
+	std::vector<std::pair<idx_t, Vector *>> metadata;
+	std::vector<std::pair<idx_t, Vector *>> hash_fields;
+	for (idx_t col = 0; col < output.ColumnCount() && col < state.column_ids.size(); col++) {
+		auto &out_vector = output.data[col];
+		auto column_id = state.column_ids[col];
+		auto metadata_column = MetadataColumn(column_id);
+
+		if (column_id == 0) {
+			out_vector.SetVectorType(VectorType::FLAT_VECTOR);
+			auto out_data = FlatVector::GetData<string_t>(out_vector);
+			for (idx_t i = 0; i < count; i++) {
+				out_data[i] = SegmentString(keys[i]);
+			}
+			StringVector::AddBuffer(out_vector, segments);
+		} else if (bind.with_values && column_id == 1) {
+			// redis_kv: one GET pipeline per output chunk, written straight into the value column.
+			out_vector.SetVectorType(VectorType::FLAT_VECTOR);
+			std::vector<idx_t> rows(count);
+			for (idx_t i = 0; i < count; i++) {
+				rows[i] = i;
+			}
+			FetchValuesInto(*state.route, keys, rows, out_vector, bind.value_format, true, "redis_kv");
+		} else if (column_id >= 1 && column_id <= bind.hash_fields.size()) {
+			out_vector.SetVectorType(VectorType::FLAT_VECTOR);
+			hash_fields.emplace_back(column_id - 1, &out_vector);
+		} else if (metadata_column.IsValid()) {
+			out_vector.SetVectorType(VectorType::FLAT_VECTOR);
+			metadata.emplace_back(metadata_column.GetIndex(), &out_vector);
+		} else if (column_id == SAMPLE_FRACTION_COLUMN) {
+			out_vector.Reference(Value::DOUBLE(state.sampler ? state.sampler->Fraction() : 1.0));
+		} else {
+			// rowid, or the placeholder of a query that needs no column at all (COUNT(*))
+			out_vector.SetVectorType(VectorType::CONSTANT_VECTOR);
+			ConstantVector::SetNull(out_vector, true);
+		}
+	}
+	FetchHashFieldsInto(state, keys, bind.hash_fields, hash_fields);
+	FetchMetadataInto(state, keys, metadata);
+}
+// EXPLAIN: the pattern and, for a pushed down TABLESAMPLE, the sampled share and seed.
+static InsertionOrderPreservingMap<string> RedisScanToString(TableFunctionToStringInput &input) {
+	InsertionOrderPreservingMap<string> result;
+	auto &bind = input.bind_data->Cast<RedisScanBindData>();
+	result["Pattern"] = bind.pattern;
+	if (bind.Sampled()) {
+		result["Sample"] = StringUtil::Format("%.4f%% (seed %llu)", bind.sample_fraction * 100,
+		                                      (unsigned long long)bind.sample_seed);
+	}
+	return result;
+}
+
+// EXPLAIN ANALYZE: the share of the keyspace the sample stands for, to scale estimates by.
+static InsertionOrderPreservingMap<string> RedisScanDynamicToString(TableFunctionDynamicToStringInput &input) {
+	InsertionOrderPreservingMap<string> result;
+	if (!input.global_state) {
+		return result;
+	}
+	// only asked for once the scan has finished, so the sampler is no longer moving
+	auto &state = input.global_state->Cast<RedisScanGlobalState>();
+	if (state.sampler) {
+		result["Sampled Fraction"] = StringUtil::Format("%.6f", state.sampler->Fraction());
+		result["Scanned Fraction"] = StringUtil::Format("%.6f", state.sampler->ScannedFraction());
+	}
+	return result;
+}
+
+// -------------------------------------------------------------------------------------------------
+//  redis_materialize(pattern, table): snapshot + incremental refresh from keyspace notifications
+// -------------------------------------------------------------------------------------------------
+
+// Changed keys are applied once this many are pending, or MATERIALIZE_FLUSH_INTERVAL after the first one.
+constexpr idx_t MATERIALIZE_MAX_BATCH = 2048;
+constexpr auto MATERIALIZE_FLUSH_INTERVAL = std::chrono::milliseconds(200);
+// How long the worker blocks on the subscription before it re-checks whether it should stop.
+constexpr int MATERIALIZE_POLL_MS = 100;
+// Pause before a worker reconnects after losing its server.
+constexpr auto WORKER_RETRY_INTERVAL = std::chrono::seconds(1);
+
+// What a background worker reports to redis_workers(); written by the worker, read by queries.
+class RedisWorkerStatus {
+public:
+	void Set(const char *status_p, const std::string &error = std::string()) {
+		std::lock_guard<std::mutex> guard(lock);
+		status = status_p;
+		if (!error.empty()) {
+			last_error = error;
+		}
+	}
+
+	void AddRows(int64_t count) {
+		std::lock_guard<std::mutex> guard(lock);
+		rows += count;
+	}
+
+	void SetRows(int64_t count) {
+		std::lock_guard<std::mutex> guard(lock);
+		rows = count;
+	}
+
+	// status, rows written, last error (NULL if none)
+	vector<Value> Row() {
+		std::lock_guard<std::mutex> guard(lock);
+		return {Value(status), Value::BIGINT(rows), last_error.empty() ? Value() : Value(last_error)};
+	}
+
+private:
+	std::mutex lock;
+	const char *status = "loading";
+	int64_t rows = 0;
+	std::string last_error;
+};
+
+// Background workers belong to one database: they are found by database and quoted table name.
+using RedisWorkerKey = std::pair<const DatabaseInstance *, std::string>;
+template <class WORKER>
+using RedisWorkerMap = std::map<RedisWorkerKey, unique_ptr<WORKER>>;
+
+/*
+  Sleeps for 'interval' in MATERIALIZE_POLL_MS steps.
+    - Returns false as soon as the worker should end instead: stop was set or its database is gone.
+*/
+static bool WorkerWait(const std::atomic<bool> &stop, const weak_ptr<DatabaseInstance> &db,
+                       std::chrono::milliseconds interval) {
+	auto until = std::chrono::steady_clock::now() + interval;
+	while (!stop && !db.expired()) {
+		if (std::chrono::steady_clock::now() >= until) {
+			return true;
+		}
+		std::this_thread::sleep_for(std::chrono::milliseconds(MATERIALIZE_POLL_MS));
+	}
+	return false;
+}
+
+/*
+  One table kept in sync with the keys matching a pattern.
+    - The worker thread only holds a weak reference to the database and checks it after every poll, so it
+      ends soon after the database is closed, on redis_materialize_stop(), or when it is replaced.
+    - Notifications are subscribed to before the snapshot is taken, so no change can fall between them.
+    - The table is created and loaded by the worker on its own connection, never inside the query that
+      called redis_materialize().
+*/
+struct RedisMaterialization {
+	std::string pattern;
+	QualifiedName table;
+	// The primary when redis_materialize() ran; a later redis_connect() does not move the table to another server.
+	RedisNodeRef node;
+	weak_ptr<DatabaseInstance> db;
+	unique_ptr<KeyspaceListener> listener;
+	RedisWorkerStatus status;
+	std::atomic<bool> stop {false};
+	std::thread worker;
+
+	~RedisMaterialization() {
+		stop = true;
+		if (worker.joinable()) {
+			worker.join();
+		}
+	}
+};
+
+std::mutex materialize_mutex;
+RedisWorkerMap<RedisMaterialization> materializations;
+
+static std::string QuotedTableName(const QualifiedName &name) {
+	std::string result;
+	if (!name.catalog.empty()) {
+		result += KeywordHelper::WriteOptionallyQuoted(name.catalog) + ".";
+	}
+	if (!name.schema.empty()) {
+		result += KeywordHelper::WriteOptionallyQuoted(name.schema) + ".";
+	}
+	return result + KeywordHelper::WriteOptionallyQuoted(name.name);
+}
+
+// GET on the primary: replicas may not have applied the write a notification announced yet.
+static const RespTape &FetchPrimaryValues(PooledClient &client, RespParser &parser,
+                                                         const std::vector<std::string_view> &keys) {
+	client->ClearBuffer();
+	parser.ClearObjects();
+	return client->RedisGetPipelined(keys, parser);
+}
+
+// Missing keys are deleted from the table; keys that are not strings stay with a NULL value, as in redis_kv.
+static bool ValueRowExists(const RespObject &reply) {
+	return reply.type != RespType::NULL_VAL;
+}
+
+static Value ValueOf(const RespObject &reply) {
+	if (reply.type != RespType::BULK_STRING && reply.type != RespType::SIMPLE_STRING) {
+		return Value(LogicalType::VARCHAR);
+	}
+	return Value(std::string(reply.AsString()));
+}
+
+// (Re)creates the table and fills it with the current keys, reusing the redis_scan cursor logic.
+static idx_t MaterializeSnapshot(DatabaseInstance &db, RedisMaterialization &m) {
+	Connection con(db);
+	auto table = QuotedTableName(m.table);
+	auto created = con.Query("CREATE OR REPLACE TABLE " + table + " (key_name VARCHAR PRIMARY KEY, value VARCHAR)");
+	if (created->HasError()) {
+		created->ThrowError("redis_materialize: ");
+	}
+
+	RedisScanGlobalState scan;
+	scan.route = redis_router.Route(m.node, ReadPolicy());
+	scan.node = scan.route->primary;
+	scan.client = make_uniq<PooledClient>(scan.node->pool);
+	PooledClient values(scan.node->pool);
+	RespParser parser;
+
+	// SCAN may return a key more than once
+	std::unordered_set<std::string> seen;
+	Appender appender(con, m.table.catalog, m.table.schema, m.table.name);
+	do {
+		FetchNextBatch(scan, m.pattern);
+		if (scan.batch_keys.empty()) {
+			continue;
+		}
+		auto &replies = FetchPrimaryValues(values, parser, scan.batch_keys);
+		for (idx_t i = 0; i < scan.batch_keys.size(); i++) {
+			auto key = scan.batch_keys[i];
+			if (!ValueRowExists(replies[i]) || !seen.emplace(key).second) {
+				continue;
+			}
+			appender.BeginRow();
+			appender.Append(Value(std::string(key)));
+			appender.Append(ValueOf(replies[i]));
+			appender.EndRow();
+		}
+	} while (!scan.done);
+	appender.Close();
+	return seen.size();
+}
+
+// Re-reads the changed keys and applies them as one transaction of upserts and deletes.
+static void MaterializeChanges(DatabaseInstance &db, RedisMaterialization &m,
+                               const std::unordered_set<std::string> &changed) {
+	std::vector<std::string_view> keys(changed.begin(), changed.end());
+	PooledClient client(m.node->pool);
+	RespParser parser;
+	auto &replies = FetchPrimaryValues(client, parser, keys);
+
+	Connection con(db);
+	auto table = QuotedTableName(m.table);
+	auto upsert = con.Prepare("INSERT OR REPLACE INTO " + table + " VALUES ($1, $2)");
+	auto remove = con.Prepare("DELETE FROM " + table + " WHERE key_name = $1");
+	if (upsert->HasError() || remove->HasError()) {
+		throw InvalidInputException("redis_materialize: %s", upsert->HasError() ? upsert->GetError() : remove->GetError());
+	}
+
+	con.BeginTransaction();
+	for (idx_t i = 0; i < keys.size(); i++) {
+		Value key(std::string(keys[i]));
+		auto result = ValueRowExists(replies[i]) ? upsert->Execute(key, ValueOf(replies[i])) : remove->Execute(key);
+		if (result->HasError()) {
+			con.Rollback();
+			result->ThrowError("redis_materialize: ");
+		}
+	}
+	con.Commit();
+}
+
+// Subscribes to the keyspace events of the materialization's server and logical database.
+static unique_ptr<KeyspaceListener> ListenForChanges(const RedisMaterialization &m) {
+	auto &endpoint = m.node->endpoint;
+	return make_uniq<KeyspaceListener>(endpoint, endpoint.db, m.pattern);
+}
+
+/*
+  Loads the snapshot, then applies changed keys in batches.
+    - Lost connections are reported as "reconnecting" and followed by a new subscription and snapshot.
+    - Database errors (e.g. the table was dropped) end the worker as "failed".
+*/
+static void MaterializeWorker(RedisMaterialization &m) {
+	std::unordered_set<std::string> changed;
+	auto first_change = std::chrono::steady_clock::now();
+	bool loaded = false;
+
+	while (!m.stop && !m.db.expired()) {
+		try {
+			if (!m.listener) {
+				m.listener = ListenForChanges(m);
+			}
+			if (!loaded) {
+				auto db = m.db.lock();
+				if (!db) {
+					break;
+				}
+				m.status.Set("loading");
+				changed.clear();
+				m.status.SetRows(static_cast<int64_t>(MaterializeSnapshot(*db, m)));
+				m.status.Set("running");
+				loaded = true;
+			}
+
+			bool was_empty = changed.empty();
+			m.listener->Poll(changed, MATERIALIZE_POLL_MS);
+			if (was_empty && !changed.empty()) {
+				first_change = std::chrono::steady_clock::now();
+			}
+			if (changed.empty() || (changed.size() < MATERIALIZE_MAX_BATCH &&
+			                        std::chrono::steady_clock::now() - first_change < MATERIALIZE_FLUSH_INTERVAL)) {
+				continue;
+			}
+			auto db = m.db.lock();
+			if (!db) {
+				break;
+			}
+			MaterializeChanges(*db, m, changed);
+			m.status.AddRows(static_cast<int64_t>(changed.size()));
+			changed.clear();
+		} catch (std::exception &ex) {
+			ErrorData error(ex);
+			if (error.Type() != ExceptionType::IO && error.Type() != ExceptionType::UNKNOWN_TYPE) {
+				m.status.Set("failed", error.Message());
+				return;
+			}
+			// events were lost with the connection: subscribe again and start over from a fresh snapshot
+			m.status.Set("reconnecting", error.Message());
+			m.listener.reset();
+			loaded = false;
+			WorkerWait(m.stop, m.db, WORKER_RETRY_INTERVAL);
+		}
+	}
+	m.status.Set("stopped");
+}
+
+// Ends the workers of databases that are gone; their entries could otherwise match a new database at the same address.
+template <class WORKER>
+static void PruneWorkers(std::mutex &mutex, RedisWorkerMap<WORKER> &workers) {
+	vector<unique_ptr<WORKER>> ended;
+	{
+		std::lock_guard<std::mutex> guard(mutex);
+		for (auto entry = workers.begin(); entry != workers.end();) {
+			if (entry->second->db.expired()) {
+				ended.push_back(std::move(entry->second));
+				entry = workers.erase(entry);
+			} else {
+				entry++;
+			}
+		}
+	}
+	// joined by the worker's destructor, outside of the lock
+}
+
+// Stops the worker of a table (if any) and waits for it.
+template <class WORKER>
+static bool StopWorker(std::mutex &mutex, RedisWorkerMap<WORKER> &workers, const RedisWorkerKey &key) {
+	PruneWorkers(mutex, workers);
+	unique_ptr<WORKER> stopped;
+	{
+		std::lock_guard<std::mutex> guard(mutex);
+		auto entry = workers.find(key);
+		if (entry == workers.end()) {
+			return false;
+		}
+		stopped = std::move(entry->second);
+		workers.erase(entry);
+	}
+	return true; // joined by the worker's destructor
+}
+
+static bool StopMaterialization(const RedisWorkerKey &key) {
+	return StopWorker(materialize_mutex, materializations, key);
+}
+
+struct RedisMaterializeBindData : public FunctionData {
+	std::string pattern;
+	std::string table;
+
+	unique_ptr<FunctionData> Copy() const override {
+		auto result = make_uniq<RedisMaterializeBindData>();
+		result->pattern = pattern;
+		result->table = table;
+		return std::move(result);
+	}
+
+	bool Equals(const FunctionData &other_p) const override {
+		auto &other = other_p.Cast<RedisMaterializeBindData>();
+		return pattern == other.pattern && table == other.table;
+	}
+};
+
+struct RedisMaterializeGlobalState : public GlobalTableFunctionState {
+	bool done = false;
+};
+
+static unique_ptr<FunctionData> RedisMaterializeBind(ClientContext &, TableFunctionBindInput &input,
+                                                     vector<LogicalType> &return_types, vector<string> &names) {
+	if (input.inputs.size() != 2 || input.inputs[0].IsNull() || input.inputs[1].IsNull()) {
+		throw InvalidInputException("redis_materialize(pattern, table) expects two non-NULL arguments");
+	}
+	auto result = make_uniq<RedisMaterializeBindData>();
+	result->pattern = input.inputs[0].GetValue<std::string>();
+	result->table = input.inputs[1].GetValue<std::string>();
+
+	return_types.push_back(LogicalType::VARCHAR);
+	names.push_back("table_name");
+	return_types.push_back(LogicalType::VARCHAR);
+	names.push_back("pattern");
+	return std::move(result);
+}
+
+static unique_ptr<GlobalTableFunctionState> RedisMaterializeInit(ClientContext &, TableFunctionInitInput &) {
+	return make_uniq<RedisMaterializeGlobalState>();
+}
+
+// Starts the worker and returns right away; redis_workers() shows when the snapshot is loaded.
+
+static void RedisMaterializeFunc(ClientContext &context, TableFunctionInput &data_p, DataChunk &output) {
+	auto &bind = data_p.bind_data->Cast<RedisMaterializeBindData>();
+	auto &state = data_p.global_state->Cast<RedisMaterializeGlobalState>();
+	if (state.done) {
+		output.SetCardinality(0);
+		return;
+	}
+	state.done = true;
+
+	auto m = make_uniq<RedisMaterialization>();
+	m->pattern = bind.pattern;
+	m->table = QualifiedName::Parse(bind.table);
+	m->db = context.db;
+	m->node = redis_router.PrimaryNode();
+	RedisWorkerKey key(context.db.get(), QuotedTableName(m->table));
+	// a table is only kept in sync by one worker
+	StopMaterialization(key);
+
+	// an unreachable server, or one without keyspace events, is reported to the caller
+	try {
+		m->listener = ListenForChanges(*m);
+	} catch (std::runtime_error &ex) {
+		throw IOException("redis_materialize: %s", ex.what());
+	}
+
+	auto &worker_state = *m;
+	m->worker = std::thread([&worker_state]() { MaterializeWorker(worker_state); });
+	{
+		std::lock_guard<std::mutex> guard(materialize_mutex);
+		materializations[key] = std::move(m);
+	}
+
+	output.SetCardinality(1);
+	output.SetValue(0, 0, Value(key.second));
+	output.SetValue(1, 0, Value(bind.pattern));
+}
+
+static void StopMaterializeScalarFun(DataChunk &args, ExpressionState &state, Vector &result) {
+	auto &db = state.GetContext().db;
+	UnaryExecutor::Execute<string_t, bool>(args.data[0], result, args.size(), [&](string_t table) {
+		return StopMaterialization(RedisWorkerKey(db.get(), QuotedTableName(QualifiedName::Parse(table.GetString()))));
+	});
+}
+
+// -------------------------------------------------------------------------------------------------
+//  redis_subscribe(channels): Pub/Sub messages as rows, written out one full vector at a time
+// -------------------------------------------------------------------------------------------------
+
+// How long one wait on the subscription lasts before interrupts, deadlines and stop requests are checked.
+constexpr int SUBSCRIBE_POLL_MS = 100;
+// The background appender flushes once this many messages are pending, or SUBSCRIBE_FLUSH_INTERVAL after the first.
+constexpr idx_t SUBSCRIBE_APPEND_BATCH = 16 * STANDARD_VECTOR_SIZE;
+// redis_subscribe() emits a partial vector once its oldest message has waited this long.
+constexpr auto SUBSCRIBE_FLUSH_INTERVAL = std::chrono::milliseconds(200);
+
+static const char *const SUBSCRIBE_COLUMN_NAMES[] = {"channel", "pattern", "payload", "received_at"};
+
+// Payloads are BLOBs, as with redis_get_blob: publishers send arbitrary bytes (protobuf, msgpack, ...), which are
+// passed through unvalidated. decode(payload) turns UTF-8 text back into a VARCHAR.
+static vector<LogicalType> SubscribeColumnTypes() {
+	return {LogicalType::VARCHAR, LogicalType::VARCHAR, LogicalType::BLOB, LogicalType::TIMESTAMP};
+}
+
+// channels is one name or a list of names; names with *, ? or [ are patterns.
+static vector<string> ParseChannels(const Value &channels, const char *function) {
+	vector<string> result;
+	if (!channels.IsNull() && channels.type().id() == LogicalTypeId::LIST) {
+		for (auto &channel : ListValue::GetChildren(channels)) {
+			if (channel.IsNull()) {
+				throw InvalidInputException("%s: channel names cannot be NULL", function);
+			}
+			result.push_back(channel.ToString());
+		}
+	} else if (!channels.IsNull()) {
+		result.push_back(channels.ToString());
+	}
+	if (result.empty()) {
+		throw InvalidInputException("%s: expected at least one channel", function);
+	}
+	return result;
+}
+
+/*
+  Messages received on a subscription but not written out yet.
+    - Channels and payloads stay in the receive segments they arrived in; 'pinned' keeps those alive
+      until the messages are in a vector, which then holds its own reference.
+*/
+struct SubscriptionBuffer {
+	unique_ptr<PubSubSubscriber> subscriber;
+	std::vector<PubSubMessage> messages;
+	std::vector<SegmentRef> pinned;
+
+	idx_t Pending() const {
+		return messages.size();
+	}
+
+	// One wait on the connection; returns how many messages arrived.
+	idx_t Poll(int timeout_ms) {
+		auto count = subscriber->Poll(messages, timeout_ms);
+		if (count > 0) {
+			for (auto &segment : subscriber->Segments()) {
+				if (std::find(pinned.begin(), pinned.end(), segment) == pinned.end()) {
+					pinned.push_back(segment);
+				}
+			}
+		}
+		subscriber->Release();
+		return count;
+	}
+
+	// Moves up to 'count' messages into chunk, without copying strings.
+	idx_t Emit(DataChunk &chunk, idx_t count) {
+		count = MinValue<idx_t>(count, messages.size());
+		auto channels = FlatVector::GetData<string_t>(chunk.data[0]);
+		auto patterns = FlatVector::GetData<string_t>(chunk.data[1]);
+		auto payloads = FlatVector::GetData<string_t>(chunk.data[2]);
+		auto received = FlatVector::GetData<timestamp_t>(chunk.data[3]);
+		auto &pattern_validity = FlatVector::Validity(chunk.data[1]);
+		for (idx_t i = 0; i < count; i++) {
+			auto &message = messages[i];
+			channels[i] = SegmentString(message.channel);
+			if (message.pattern.empty()) {
+				pattern_validity.SetInvalid(i);
+			} else {
+				patterns[i] = SegmentString(message.pattern);
+			}
+			payloads[i] = SegmentString(message.payload);
+			received[i] = timestamp_t(
+			    std::chrono::duration_cast<std::chrono::microseconds>(message.received.time_since_epoch()).count());
+		}
+		if (count > 0) {
+			auto segments = make_buffer<RedisSegmentBuffer>(pinned);
+			for (idx_t column = 0; column < 3; column++) {
+				StringVector::AddBuffer(chunk.data[column], segments);
+			}
+		}
+		chunk.SetCardinality(count);
+
+		messages.erase(messages.begin(), messages.begin() + static_cast<std::ptrdiff_t>(count));
+		// segments before the one holding the oldest remaining message are no longer needed here
+		if (messages.empty()) {
+			pinned.clear();
+		} else {
+			auto oldest = messages.front().channel.data();
+			auto holder = std::find_if(pinned.begin(), pinned.end(), [&](const SegmentRef &segment) {
+				return oldest >= segment->data && oldest < segment->data + segment->capacity;
+			});
+			pinned.erase(pinned.begin(), holder == pinned.end() ? pinned.begin() : holder);
+		}
+		return count;
+	}
+};
+
+struct RedisSubscribeBindData : public FunctionData {
+	vector<string> channels;
+	// -1: no limit
+	int64_t max_messages = -1;
+	int64_t max_duration_us = -1;
+
+	unique_ptr<FunctionData> Copy() const override {
+		auto result = make_uniq<RedisSubscribeBindData>();
+		result->channels = channels;
+		result->max_messages = max_messages;
+		result->max_duration_us = max_duration_us;
+		return std::move(result);
+	}
+
+	bool Equals(const FunctionData &other_p) const override {
+		auto &other = other_p.Cast<RedisSubscribeBindData>();
+		return channels == other.channels && max_messages == other.max_messages &&
+		       max_duration_us == other.max_duration_us;
+	}
+};
+
+struct RedisSubscribeGlobalState : public GlobalTableFunctionState {
+	SubscriptionBuffer buffer;
+	idx_t emitted = 0;
+	// Counted from the moment the subscriptions are confirmed.
+	std::chrono::steady_clock::time_point deadline;
+	// When the oldest pending message arrived.
+	std::chrono::steady_clock::time_point first_pending;
+};
+
+static unique_ptr<FunctionData> RedisSubscribeBind(ClientContext &context, TableFunctionBindInput &input,
+                                                   vector<LogicalType> &return_types, vector<string> &names) {
+	auto result = make_uniq<RedisSubscribeBindData>();
+	result->channels = ParseChannels(input.inputs[0], "redis_subscribe");
+	auto entry = input.named_parameters.find("max_messages");
+	if (entry != input.named_parameters.end() && !entry->second.IsNull()) {
+		result->max_messages = MaxValue<int64_t>(0, entry->second.GetValue<int64_t>());
+	}
+	entry = input.named_parameters.find("max_duration");
+	if (entry != input.named_parameters.end() && !entry->second.IsNull()) {
+		result->max_duration_us = MaxValue<int64_t>(0, Interval::GetMicro(entry->second.GetValue<interval_t>()));
+	}
+
+	return_types = SubscribeColumnTypes();
+	names.assign(std::begin(SUBSCRIBE_COLUMN_NAMES), std::end(SUBSCRIBE_COLUMN_NAMES));
+	return std::move(result);
+}
+
+// Subscribes on a connection of its own: a subscribed connection cannot run other commands.
+static unique_ptr<PubSubSubscriber> Subscribe(const RedisEndpoint &endpoint, const vector<string> &channels,
+                                              const char *function) {
+	try {
+		return make_uniq<PubSubSubscriber>(endpoint, channels);
+	} catch (std::runtime_error &ex) {
+		throw IOException("%s: %s", function, ex.what());
+	}
+}
+
+static unique_ptr<GlobalTableFunctionState> RedisSubscribeInit(ClientContext &, TableFunctionInitInput &input) {
+	auto &bind = input.bind_data->Cast<RedisSubscribeBindData>();
+	auto state = make_uniq<RedisSubscribeGlobalState>();
+	state->buffer.subscriber = Subscribe(redis_router.PrimaryNode()->endpoint, bind.channels, "redis_subscribe");
+	state->deadline = std::chrono::steady_clock::now() + std::chrono::microseconds(MaxValue<int64_t>(0, bind.max_duration_us));
+	return std::move(state);
+}
+
+/*
+  Emits a vector once it is full, once a poll times out with messages pending, or SUBSCRIBE_FLUSH_INTERVAL
+  after the oldest pending message arrived, so a slow trickle is not held back. Without max_messages or
+  max_duration it runs until it is interrupted or a LIMIT is satisfied.
+*/
+static void RedisSubscribeFunc(ClientContext &context, TableFunctionInput &data_p, DataChunk &output) {
+	auto &bind = data_p.bind_data->Cast<RedisSubscribeBindData>();
+	auto &state = data_p.global_state->Cast<RedisSubscribeGlobalState>();
+
+	idx_t wanted = STANDARD_VECTOR_SIZE;
+	if (bind.max_messages >= 0) {
+		wanted = MinValue<idx_t>(wanted, static_cast<idx_t>(bind.max_messages) - state.emitted);
+	}
+	while (state.buffer.Pending() < wanted) {
+		if (context.interrupted) {
+			throw InterruptException();
+		}
+		if (state.buffer.Pending() > 0 &&
+		    std::chrono::steady_clock::now() - state.first_pending >= SUBSCRIBE_FLUSH_INTERVAL) {
+			break;
+		}
+		int wait = SUBSCRIBE_POLL_MS;
+		if (bind.max_duration_us >= 0) {
+			auto left = std::chrono::duration_cast<std::chrono::milliseconds>(state.deadline -
+			                                                                   std::chrono::steady_clock::now());
+			if (left.count() <= 0) {
+				break;
+			}
+			wait = static_cast<int>(MinValue<int64_t>(wait, left.count()));
+		}
+		bool was_empty = state.buffer.Pending() == 0;
+		idx_t arrived;
+		try {
+			arrived = state.buffer.Poll(wait);
+		} catch (std::runtime_error &ex) {
+			throw IOException("redis_subscribe: %s", ex.what());
+		}
+		if (was_empty && arrived > 0) {
+			state.first_pending = std::chrono::steady_clock::now();
+		} else if (arrived == 0 && !was_empty) {
+			// the channel went quiet: hand out what there is
+			break;
+		}
+	}
+	state.emitted += state.buffer.Emit(output, wanted);
+	if (state.buffer.Pending() > 0) {
+		// the rest arrived together with what was just emitted
+		state.first_pending = std::chrono::steady_clock::now();
+	}
+}
+
+/*
+  Background mode: redis_subscribe_into(channels, table) appends every message to a table.
+    - Messages are collected into full vectors and appended in one transaction per flush.
+    - As with redis_materialize the worker only holds a weak reference to the database and checks it after
+      every poll; it stops once the database is gone, on redis_subscribe_stop(), or when it is replaced.
+    - The table is created by the worker on its own connection, never inside the query that called
+      redis_subscribe_into().
+    - Pub/Sub delivers at most once: messages published while the connection is down are lost.
+*/
+struct RedisSubscription {
+	vector<string> channels;
+	// The primary when redis_subscribe_into() ran; reconnects go back to it, whatever redis_connect() says by then.
+	RedisEndpoint endpoint;
+	QualifiedName table;
+	weak_ptr<DatabaseInstance> db;
+	SubscriptionBuffer buffer;
+	RedisWorkerStatus status;
+	std::atomic<bool> stop {false};
+	std::thread worker;
+
+	~RedisSubscription() {
+		stop = true;
+		if (worker.joinable()) {
+			worker.join();
+		}
+	}
+};
+
+std::mutex subscribe_mutex;
+RedisWorkerMap<RedisSubscription> subscriptions;
+
+static void CreateSubscriptionTable(DatabaseInstance &db, const QualifiedName &table) {
+	Connection con(db);
+	auto created = con.Query("CREATE TABLE IF NOT EXISTS " + QuotedTableName(table) +
+	                         " (channel VARCHAR, pattern VARCHAR, payload BLOB, received_at TIMESTAMP)");
+	if (created->HasError()) {
+		created->ThrowError("redis_subscribe_into: ");
+	}
+}
+
+// Appends every pending message; returns how many there were.
+static idx_t AppendPendingMessages(DatabaseInstance &db, RedisSubscription &s) {
+	Connection con(db);
+	Appender appender(con, s.table.catalog, s.table.schema, s.table.name);
+	DataChunk chunk;
+	chunk.Initialize(Allocator::DefaultAllocator(), SubscribeColumnTypes());
+	idx_t count = 0;
+	while (s.buffer.Pending() > 0) {
+		chunk.Reset();
+		count += s.buffer.Emit(chunk, STANDARD_VECTOR_SIZE);
+		appender.AppendDataChunk(chunk);
+	}
+	appender.Close();
+	return count;
+}
+
+/*
+  Creates the table, then appends messages in batches.
+    - Lost connections are reported as "reconnecting" and followed by a new subscription; messages
+      received before are still appended.
+    - Database errors (e.g. the table was dropped or altered) end the worker as "failed".
+*/
+static void SubscriptionWorker(RedisSubscription &s) {
+	auto first_message = std::chrono::steady_clock::now();
+	bool created = false;
+
+	while (!s.stop && !s.db.expired()) {
+		try {
+			if (!created) {
+				auto db = s.db.lock();
+				if (!db) {
+					break;
+				}
+				CreateSubscriptionTable(*db, s.table);
+				created = true;
+				s.status.Set("running");
+			}
+			if (!s.buffer.subscriber) {
+				s.buffer.subscriber = make_uniq<PubSubSubscriber>(s.endpoint, s.channels);
+				s.status.Set("running");
+			}
+
+			bool was_empty = s.buffer.Pending() == 0;
+			s.buffer.Poll(SUBSCRIBE_POLL_MS);
+			if (was_empty && s.buffer.Pending() > 0) {
+				first_message = std::chrono::steady_clock::now();
+			}
+			if (s.buffer.Pending() == 0 ||
+			    (s.buffer.Pending() < SUBSCRIBE_APPEND_BATCH &&
+			     std::chrono::steady_clock::now() - first_message < SUBSCRIBE_FLUSH_INTERVAL)) {
+				continue;
+			}
+			auto db = s.db.lock();
+			if (!db) {
+				break;
+			}
+			s.status.AddRows(static_cast<int64_t>(AppendPendingMessages(*db, s)));
+		} catch (std::exception &ex) {
+			ErrorData error(ex);
+			if (error.Type() != ExceptionType::IO && error.Type() != ExceptionType::UNKNOWN_TYPE) {
+				s.status.Set("failed", error.Message());
+				return;
+			}
+			s.status.Set("reconnecting", error.Message());
+			s.buffer.subscriber.reset();
+			WorkerWait(s.stop, s.db, WORKER_RETRY_INTERVAL);
+		}
+	}
+
+	// stopped: what has been received so far still goes in
+	auto db = s.db.lock();
+	if (db && created && s.buffer.Pending() > 0) {
+		try {
+			s.status.AddRows(static_cast<int64_t>(AppendPendingMessages(*db, s)));
+		} catch (std::exception &ex) {
+			s.status.Set("failed", ErrorData(ex).Message());
+			return;
+		}
+	}
+	s.status.Set("stopped");
+}
+
+static bool StopSubscription(const RedisWorkerKey &key) {
+	return StopWorker(subscribe_mutex, subscriptions, key);
+}
+
+struct RedisSubscribeIntoBindData : public FunctionData {
+	vector<string> channels;
+	std::string table;
+
+	unique_ptr<FunctionData> Copy() const override {
+		auto result = make_uniq<RedisSubscribeIntoBindData>();
+		result->channels = channels;
+		result->table = table;
+		return std::move(result);
+	}
+
+	bool Equals(const FunctionData &other_p) const override {
+		auto &other = other_p.Cast<RedisSubscribeIntoBindData>();
+		return channels == other.channels && table == other.table;
+	}
+};
+
+struct RedisSubscribeIntoGlobalState : public GlobalTableFunctionState {
+	bool done = false;
+};
+
+static unique_ptr<FunctionData> RedisSubscribeIntoBind(ClientContext &context, TableFunctionBindInput &input,
+                                                       vector<LogicalType> &return_types, vector<string> &names) {
+	if (input.inputs.size() != 2 || input.inputs[1].IsNull()) {
+		throw InvalidInputException("redis_subscribe_into(channels, table) expects a non-NULL table name");
+	}
+	auto result = make_uniq<RedisSubscribeIntoBindData>();
+	result->channels = ParseChannels(input.inputs[0], "redis_subscribe_into");
+	result->table = input.inputs[1].GetValue<std::string>();
+
+	return_types.push_back(LogicalType::VARCHAR);
+	names.push_back("table_name");
+	return_types.push_back(LogicalType::BIGINT);
+	names.push_back("channels");
+	return std::move(result);
+}
+
+static unique_ptr<GlobalTableFunctionState> RedisSubscribeIntoInit(ClientContext &, TableFunctionInitInput &) {
+	return make_uniq<RedisSubscribeIntoGlobalState>();
+}
+
+// Subscribes, starts the worker and returns right away; redis_workers() shows how it is doing.
+static void RedisSubscribeIntoFunc(ClientContext &context, TableFunctionInput &data_p, DataChunk &output) {
+	auto &bind = data_p.bind_data->Cast<RedisSubscribeIntoBindData>();
+	auto &state = data_p.global_state->Cast<RedisSubscribeIntoGlobalState>();
+	if (state.done) {
+		output.SetCardinality(0);
+		return;
+	}
+	state.done = true;
+
+	auto s = make_uniq<RedisSubscription>();
+	s->channels = bind.channels;
+	s->endpoint = redis_router.PrimaryNode()->endpoint;
+	s->table = QualifiedName::Parse(bind.table);
+	s->db = context.db;
+	s->status.Set("starting");
+	RedisWorkerKey key(context.db.get(), QuotedTableName(s->table));
+	// a table is only appended to by one worker
+	StopSubscription(key);
+
+	// an unreachable server is reported to the caller
+	s->buffer.subscriber = Subscribe(s->endpoint, s->channels, "redis_subscribe_into");
+
+	auto &worker_state = *s;
+	s->worker = std::thread([&worker_state]() { SubscriptionWorker(worker_state); });
+	{
+		std::lock_guard<std::mutex> guard(subscribe_mutex);
+		subscriptions[key] = std::move(s);
+	}
+
+	output.SetCardinality(1);
+	output.SetValue(0, 0, Value(key.second));
+	output.SetValue(1, 0, Value::BIGINT(static_cast<int64_t>(bind.channels.size())));
+}
+
+static void StopSubscribeScalarFun(DataChunk &args, ExpressionState &state, Vector &result) {
+	auto &db = state.GetContext().db;
+	UnaryExecutor::Execute<string_t, bool>(args.data[0], result, args.size(), [&](string_t table) {
+		return StopSubscription(RedisWorkerKey(db.get(), QuotedTableName(QualifiedName::Parse(table.GetString()))));
+	});
+}
+
+// redis_publish(channel, message): PUBLISH on the primary; returns how many subscribers received the message.
+// message is a VARCHAR or a BLOB.
+static void PublishScalarFun(DataChunk &args, ExpressionState &, Vector &result) {
+	try {
+		PooledClient client(redis_router.PrimaryNode()->pool);
+		RespParser parser;
+		BinaryExecutor::Execute<string_t, string_t, int64_t>(
+		    args.data[0], args.data[1], result, args.size(), [&](string_t channel, string_t message) {
+			    auto &reply = client->RunCommand({"PUBLISH", std::string_view(channel.GetData(), channel.GetSize()),
+			                                      std::string_view(message.GetData(), message.GetSize())},
+			                                     parser);
+			    if (reply.type != RespType::INT) {
+				    throw IOException("redis_publish: %s", std::string(reply.AsString()));
+			    }
+			    return reply.int_val;
+		    });
+	} catch (Exception &) {
+		throw;
+	} catch (std::runtime_error &ex) {
+		throw IOException("redis_publish: %s", ex.what());
+	}
+}
+
+// -------------------------------------------------------------------------------------------------
+//  redis_workers(): the background workers of this database and how they are doing
+// -------------------------------------------------------------------------------------------------
+
+struct RedisWorkersGlobalState : public GlobalTableFunctionState {
+	vector<vector<Value>> rows;
+	idx_t position = 0;
+};
+
+static unique_ptr<FunctionData> RedisWorkersBind(ClientContext &, TableFunctionBindInput &,
+                                                 vector<LogicalType> &return_types, vector<string> &names) {
+	names = {"kind", "table_name", "source", "status", "rows", "last_error"};
+	return_types = {LogicalType::VARCHAR, LogicalType::VARCHAR, LogicalType::VARCHAR,
+	                LogicalType::VARCHAR, LogicalType::BIGINT,  LogicalType::VARCHAR};
+	return nullptr;
+}
+
+static unique_ptr<GlobalTableFunctionState> RedisWorkersInit(ClientContext &context, TableFunctionInitInput &) {
+	auto state = make_uniq<RedisWorkersGlobalState>();
+	auto add_row = [&](const char *kind, const std::string &table, const std::string &source,
+	                   RedisWorkerStatus &status) {
+		vector<Value> row {Value(kind), Value(table), Value(source)};
+		for (auto &value : status.Row()) {
+			row.push_back(std::move(value));
+		}
+		state->rows.push_back(std::move(row));
+	};
+	{
+		std::lock_guard<std::mutex> guard(materialize_mutex);
+		for (auto &entry : materializations) {
+			if (entry.first.first == context.db.get()) {
+				add_row("materialize", entry.first.second, entry.second->pattern, entry.second->status);
+			}
+		}
+	}
+	std::lock_guard<std::mutex> guard(subscribe_mutex);
+	for (auto &entry : subscriptions) {
+		if (entry.first.first == context.db.get()) {
+			add_row("subscribe", entry.first.second, StringUtil::Join(entry.second->channels, ","),
+			        entry.second->status);
+		}
+	}
+	return std::move(state);
+}
+
+static void RedisWorkersFunc(ClientContext &, TableFunctionInput &data_p, DataChunk &output) {
+	auto &state = data_p.global_state->Cast<RedisWorkersGlobalState>();
+	idx_t count = 0;
+	for (; state.position < state.rows.size() && count < STANDARD_VECTOR_SIZE; state.position++, count++) {
+		auto &row = state.rows[state.position];
+		for (idx_t col = 0; col < row.size(); col++) {
+			output.SetValue(col, count, row[col]);
+		}
+	}
+	output.SetCardinality(count);
+}
+
+// -------------------------------------------------------------------------------------------------
+//  Aggregate pushdown: COUNT/SUM/MIN/MAX over redis_scan / redis_kv evaluated by a Lua script
+// -------------------------------------------------------------------------------------------------
+
+/*
+  Walks at most ARGV[4] SCAN pages per call so a single script never blocks the server for long.
+  ARGV: cursor, pattern, page COUNT, pages per call, '1' if values are needed.
+  Returns {cursor, keys, string values, other values, sum, min, max}; numbers that are not
+  plain counters are returned as strings because Redis truncates Lua numbers to integers.
+    - Only plain decimals (optional '-', digits with at most one '.', exponent of up to two digits)
+      are summed by the script; Lua's tonumber() also accepts hex, surrounding spaces and values
+      DuckDB casts differently. Every other value is returned as is and cast by DuckDB.
+*/
+static const std::string REDIS_AGGREGATE_SCRIPT = R"lua(
+local cursor = ARGV[1]
+local budget = tonumber(ARGV[4])
+local need_values = ARGV[5] == '1'
+local keys, values, others = 0, 0, {}
+local sum, min, max = 0, nil, nil
+local function plain(v)
+  if #v > 32 then return nil end
+  local mantissa, exponent = string.match(v, '^%-?(%d*%.?%d*)(.*)$')
+  if mantissa == nil or not string.find(mantissa, '%d') then return nil end
+  if exponent ~= '' and not string.find(exponent, '^[eE][+-]?%d%d?$') then return nil end
+  return tonumber(v)
+end
+repeat
+  local page = redis.call('SCAN', cursor, 'MATCH', ARGV[2], 'COUNT', ARGV[3])
+  cursor = page[1]
+  keys = keys + #page[2]
+  if need_values then
+    for _, key in ipairs(page[2]) do
+      local v = redis.pcall('GET', key)
+      if type(v) == 'string' then
+        values = values + 1
+        local n = plain(v)
+        if n == nil then
+          others[#others + 1] = v
+        else
+          sum = sum + n
+          if min == nil or n < min then min = n end
+          if max == nil or n > max then max = n end
+        end
+      end
+    end
+  end
+  budget = budget - 1
+until cursor == '0' or budget <= 0
+local function num(n)
+  if n == nil then return '' end
+  return string.format('%.17g', n)
+end
+return {cursor, keys, values, others, num(sum), num(min), num(max)}
+)lua";
+
+static const std::string REDIS_AGGREGATE_SCRIPT_SHA = RedisClient::ScriptSha1(REDIS_AGGREGATE_SCRIPT);
+
+// SCAN COUNT hint used inside the script.
+constexpr idx_t REDIS_AGGREGATE_PAGE_SIZE = 1000;
+
+enum class RedisAggregateKind : uint8_t { COUNT_KEYS, COUNT_VALUES, SUM, MIN, MAX };
+
+struct RedisAggregateBindData : public FunctionData {
+	std::string pattern;
+	std::vector<RedisAggregateKind> aggregates;
+	bool need_values = false;
+	idx_t pages_per_call = 10;
+	// the route of the scan the aggregate replaces
+	RedisRouteRef route;
+
+	unique_ptr<FunctionData> Copy() const override {
+		auto result = make_uniq<RedisAggregateBindData>();
+		result->pattern = pattern;
+		result->aggregates = aggregates;
+		result->need_values = need_values;
+		result->pages_per_call = pages_per_call;
+		result->route = route;
+		return std::move(result);
+	}
+
+	bool Equals(const FunctionData &other_p) const override {
+		auto &other = other_p.Cast<RedisAggregateBindData>();
+		return pattern == other.pattern && aggregates == other.aggregates && need_values == other.need_values &&
+		       pages_per_call == other.pages_per_call;
+	}
+};
+
+struct RedisAggregateGlobalState : public GlobalTableFunctionState {
+	bool done = false;
+};
+
+static unique_ptr<GlobalTableFunctionState> RedisAggregateInit(ClientContext &, TableFunctionInitInput &) {
+	return make_uniq<RedisAggregateGlobalState>();
+}
+
+static double ParseScriptDouble(const RespObject &obj) {
+	std::string text(obj.AsString());
+	return std::strtod(text.c_str(), nullptr);
+}
+
+// Runs the script until the cursor wraps around, merges the partial aggregates and emits one row.
+static void RedisAggregateFunc(ClientContext &, TableFunctionInput &data_p, DataChunk &output) {
+	auto &bind = data_p.bind_data->Cast<RedisAggregateBindData>();
+	auto &state = data_p.global_state->Cast<RedisAggregateGlobalState>();
+	if (state.done) {
+		output.SetCardinality(0);
+		return;
+	}
+	state.done = true;
+
+	int64_t keys = 0, values = 0, bad = 0;
+	idx_t numeric = 0;
+	double sum = 0, min = 0, max = 0;
+	// DuckDB's ordering, in which NaN is the largest value
+	auto merge = [&](double part_min, double part_max, double part_sum) {
+		min = numeric == 0 || LessThan::Operation(part_min, min) ? part_min : min;
+		max = numeric == 0 || GreaterThan::Operation(part_max, max) ? part_max : max;
+		sum += part_sum;
+		numeric++;
+	};
+
+	std::string cursor = "0";
+	std::string page_size = std::to_string(REDIS_AGGREGATE_PAGE_SIZE);
+	std::string pages_per_call = std::to_string(bind.pages_per_call);
+	RespParser parser;
+
+	// The whole aggregate runs on one node, like the scan it replaces.
+	auto node = redis_router.PickScanNode(*bind.route);
+	auto &policy = bind.route->policy;
+	unique_ptr<PooledClient> client;
+	do {
+		std::vector<std::string_view> args = {cursor, bind.pattern, page_size, pages_per_call,
+		                                      bind.need_values ? "1" : "0"};
+		// The script only reads, so a failed call is repeated from the same cursor on a new connection.
+		const RespObject *reply = nullptr;
+		for (int64_t attempt = 0; !reply; attempt++) {
+			try {
+				if (!client) {
+					client = LeaseClient(node, policy);
+				}
+				reply = &(*client)->EvalCached(REDIS_AGGREGATE_SCRIPT, REDIS_AGGREGATE_SCRIPT_SHA, args, parser);
+			} catch (Exception &) {
+				throw;
+			} catch (std::runtime_error &ex) {
+				redis_router.MarkFailed(node);
+				parser.ClearObjects();
+				client.reset();
+				if (attempt >= policy.retries) {
+					throw IOException("redis aggregate pushdown: %s", ex.what());
+				}
+			}
+		}
+		if (reply->type == RespType::ERROR) {
+			throw InvalidInputException("redis aggregate pushdown: %s", std::string(reply->AsString()));
+		}
+		if (reply->type != RespType::ARRAY || reply->children.size() < 7 ||
+		    reply->children[3].type != RespType::ARRAY) {
+			throw InvalidInputException("redis aggregate pushdown: unexpected script reply shape");
+		}
+		auto &parts = reply->children;
+		cursor = std::string(parts[0].AsString());
+		keys += parts[1].int_val;
+		values += parts[2].int_val;
+
+		// pages without numeric values report empty min/max
+		if (!parts[5].AsString().empty()) {
+			merge(ParseScriptDouble(parts[5]), ParseScriptDouble(parts[6]), ParseScriptDouble(parts[4]));
+		}
+		// values the script left alone go through the same cast as the un-pushed plan
+		for (auto &other : parts[3].children) {
+			double value;
+			auto text = other.AsString();
+			if (TryCast::Operation(string_t(text.data(), static_cast<uint32_t>(text.size())), value, false)) {
+				merge(value, value, value);
+			} else {
+				bad++;
+			}
+		}
+	} while (cursor != "0");
+	(*client)->ClearBuffer();
+
+	if (bad > 0) {
+		// the un-pushed plan would have failed on CAST(value AS DOUBLE) as well
+		throw ConversionException("Could not convert %lld redis_kv value(s) matching '%s' to DOUBLE", (long long)bad,
+		                          bind.pattern);
+	}
+
+	output.SetCardinality(1);
+	for (idx_t col = 0; col < bind.aggregates.size(); col++) {
+		switch (bind.aggregates[col]) {
+		case RedisAggregateKind::COUNT_KEYS:
+			output.SetValue(col, 0, Value::BIGINT(keys));
+			break;
+		case RedisAggregateKind::COUNT_VALUES:
+			output.SetValue(col, 0, Value::BIGINT(values));
+			break;
+		case RedisAggregateKind::SUM:
+			output.SetValue(col, 0, numeric ? Value::DOUBLE(sum) : Value(LogicalType::DOUBLE));
+			break;
+		case RedisAggregateKind::MIN:
+			output.SetValue(col, 0, numeric ? Value::DOUBLE(min) : Value(LogicalType::DOUBLE));
+			break;
+		case RedisAggregateKind::MAX:
+			output.SetValue(col, 0, numeric ? Value::DOUBLE(max) : Value(LogicalType::DOUBLE));
+			break;
+		}
+	}
+}
+
+// Returns which redis_scan/redis_kv column (0 = key_name, 1 = value) an expression reads, if it is a plain column.
+static optional_idx ScanColumn(const Expression &expr, LogicalGet &get) {
+	if (expr.GetExpressionClass() != ExpressionClass::BOUND_COLUMN_REF) {
+		return optional_idx();
+	}
+	auto &colref = expr.Cast<BoundColumnRefExpression>();
+	auto &column_ids = get.GetColumnIds();
+	if (colref.binding.table_index != get.table_index || colref.binding.column_index >= column_ids.size()) {
+		return optional_idx();
+	}
+	auto column = column_ids[colref.binding.column_index].GetPrimaryIndex();
+	if (column > 1) {
+		return optional_idx();
+	}
+	return optional_idx(column);
+}
+
+// Maps one aggregate onto what the script computes; false if it cannot be pushed down.
+static bool MatchPushdownAggregate(Expression &expr, LogicalGet &get, RedisAggregateKind &kind) {
+	if (expr.GetExpressionClass() != ExpressionClass::BOUND_AGGREGATE) {
+		return false;
+	}
+	auto &aggr = expr.Cast<BoundAggregateExpression>();
+	if (aggr.IsDistinct() || aggr.filter || aggr.order_bys) {
+		return false;
+	}
+	auto &name = aggr.function.name;
+
+	if (name == "count_star" && aggr.children.empty()) {
+		kind = RedisAggregateKind::COUNT_KEYS;
+		return true;
+	}
+	if (aggr.children.size() != 1) {
+		return false;
+	}
+	auto &child = *aggr.children[0];
+
+	if (name == "count") {
+		auto column = ScanColumn(child, get);
+		if (!column.IsValid()) {
+			return false;
+		}
+		kind = column.GetIndex() == 0 ? RedisAggregateKind::COUNT_KEYS : RedisAggregateKind::COUNT_VALUES;
+		return true;
+	}
+
+	// SUM/MIN/MAX only over CAST(value AS DOUBLE): Lua numbers are doubles, anything else would change results.
+	if (name != "sum" && name != "min" && name != "max") {
+		return false;
+	}
+	if (child.GetExpressionClass() != ExpressionClass::BOUND_CAST) {
+		return false;
+	}
+	auto &cast = child.Cast<BoundCastExpression>();
+	if (cast.try_cast || cast.return_type.id() != LogicalTypeId::DOUBLE ||
+	    cast.child->return_type.id() != LogicalTypeId::VARCHAR) {
+		return false;
+	}
+	auto column = ScanColumn(*cast.child, get);
+	if (!column.IsValid() || column.GetIndex() != 1) {
+		return false;
+	}
+	kind = name == "sum" ? RedisAggregateKind::SUM : name == "min" ? RedisAggregateKind::MIN : RedisAggregateKind::MAX;
+	return true;
+}
+
+/*
+  Rewrites   AGGREGATE(no groups) -> GET redis_scan/redis_kv
+  into       PROJECTION(aggregate_index) -> GET redis_aggregate
+  The projection reuses the aggregate's table index, so operators above keep their bindings.
+*/
+static void RedisAggregatePushdown(OptimizerExtensionInput &input, unique_ptr<LogicalOperator> &plan) {
+	for (auto &child : plan->children) {
+		RedisAggregatePushdown(input, child);
+	}
+
+	if (plan->type != LogicalOperatorType::LOGICAL_AGGREGATE_AND_GROUP_BY || plan->children.size() != 1 ||
+	    plan->children[0]->type != LogicalOperatorType::LOGICAL_GET) {
+		return;
+	}
+	auto &aggr = plan->Cast<LogicalAggregate>();
+	auto &get = plan->children[0]->Cast<LogicalGet>();
+	if (!aggr.groups.empty() || !aggr.grouping_functions.empty() || aggr.expressions.empty()) {
+		return;
+	}
+	if (get.function.name != "redis_scan" && get.function.name != "redis_kv") {
+		return;
+	}
+	if (!get.table_filters.filters.empty() || !get.bind_data) {
+		return;
+	}
+	auto &scan_bind = get.bind_data->Cast<RedisScanBindData>();
+	// the script only understands plain, uncompressed string values, and walks the whole keyspace
+	if (scan_bind.value_format.type != RedisValueType::VARCHAR ||
+	    scan_bind.value_format.compression != ValueCompression::NONE || scan_bind.Sampled()) {
+		return;
+	}
+
+	Value enabled;
+	if (input.context.TryGetCurrentSetting("redis_aggregate_pushdown", enabled) && !enabled.IsNull() &&
+	    !BooleanValue::Get(enabled)) {
+		return;
+	}
+
+	auto bind = make_uniq<RedisAggregateBindData>();
+	bind->pattern = scan_bind.pattern;
+	bind->route = scan_bind.route;
+	Value pages_per_call;
+	if (input.context.TryGetCurrentSetting("redis_pushdown_pages_per_call", pages_per_call) &&
+	    !pages_per_call.IsNull()) {
+		bind->pages_per_call = MaxValue<idx_t>(1, pages_per_call.GetValue<uint64_t>());
+	}
+
+	vector<LogicalType> types;
+	vector<string> names;
+	for (auto &expr : aggr.expressions) {
+		RedisAggregateKind kind;
+		if (!MatchPushdownAggregate(*expr, get, kind)) {
+			return;
+		}
+		bind->aggregates.push_back(kind);
+		bind->need_values |= kind != RedisAggregateKind::COUNT_KEYS;
+		types.push_back(expr->return_type);
+		names.push_back("aggregate_" + std::to_string(names.size()));
+	}
+
+	auto table_index = input.optimizer.binder.GenerateTableIndex();
+	TableFunction aggregate_func("redis_aggregate", {}, RedisAggregateFunc, nullptr, RedisAggregateInit);
+	auto new_get = make_uniq<LogicalGet>(table_index, aggregate_func, std::move(bind), types, names);
+	vector<unique_ptr<Expression>> projections;
+	for (idx_t i = 0; i < types.size(); i++) {
+		new_get->AddColumnId(i);
+		projections.push_back(make_uniq<BoundColumnRefExpression>(types[i], ColumnBinding(table_index, i)));
+	}
+
+	auto projection = make_uniq<LogicalProjection>(aggr.aggregate_index, std::move(projections));
+	projection->children.push_back(std::move(new_get));
+	plan = std::move(projection);
+}
+
+// -------------------------------------------------------------------------------------------------
+//  TABLESAMPLE pushdown: sample slices of the SCAN cursor space instead of discarding scanned rows
+// -------------------------------------------------------------------------------------------------
+
+/*
+  Replaces SAMPLE(p% SYSTEM) over redis_scan/redis_kv with a sampled scan.
+    - Only percentages with the SYSTEM method (the default of TABLESAMPLE p% / USING SAMPLE p%) are
+      pushed: whole pages are kept or skipped, the same granularity SYSTEM sampling has on tables.
+    - Filters and projections between the sample and the scan do not depend on which rows are
+      sampled, so USING SAMPLE above a WHERE clause is pushed as well.
+    - Without REPEATABLE (seed) a seed is drawn now, so all threads of the scan agree on the slices.
+*/
+static void RedisSamplePushdown(OptimizerExtensionInput &input, unique_ptr<LogicalOperator> &plan) {
+	for (auto &child : plan->children) {
+		RedisSamplePushdown(input, child);
+	}
+	if (plan->type != LogicalOperatorType::LOGICAL_SAMPLE || plan->children.size() != 1) {
+		return;
+	}
+	auto &sample = plan->Cast<LogicalSample>();
+	auto &options = *sample.sample_options;
+	if (options.method != SampleMethod::SYSTEM_SAMPLE || !options.is_percentage) {
+		return;
+	}
+
+	LogicalOperator *op = plan->children[0].get();
+	while ((op->type == LogicalOperatorType::LOGICAL_PROJECTION || op->type == LogicalOperatorType::LOGICAL_FILTER) &&
+	       op->children.size() == 1) {
+		op = op->children[0].get();
+	}
+	if (op->type != LogicalOperatorType::LOGICAL_GET) {
+		return;
+	}
+	auto &get = op->Cast<LogicalGet>();
+	if ((get.function.name != "redis_scan" && get.function.name != "redis_kv") || !get.bind_data) {
+		return;
+	}
+	auto &scan_bind = get.bind_data->Cast<RedisScanBindData>();
+	if (scan_bind.Sampled()) {
+		return;
+	}
+
+	auto percentage = options.sample_size.GetValue<double>();
+	scan_bind.sample_fraction = MinValue<double>(MaxValue<double>(percentage / 100, 0), 1);
+	if (options.seed.IsValid()) {
+		scan_bind.sample_seed = options.seed.GetIndex();
+	} else {
+		std::random_device random;
+		scan_bind.sample_seed = (uint64_t(random()) << 32) | random();
+	}
+	// a full sample needs no slices at all
+	if (scan_bind.sample_fraction >= 1) {
+		scan_bind.sample_fraction = -1;
+	}
+	plan = std::move(plan->children[0]);
+}
+
+// -------------------------------------------------------------------------------------------------
+//  redis_lrange(pattern_or_key, start, stop): list elements as (key_name, idx, value) rows
+// -------------------------------------------------------------------------------------------------
+
+// Elements requested per round of LRANGE windows; the windows of all lists in a round share this budget.
+static constexpr int64_t LRANGE_ROUND_ELEMENTS = 8 * STANDARD_VECTOR_SIZE;
+// Smallest window per list, so a page of many short lists still needs only a round or two.
+static constexpr int64_t LRANGE_MIN_WINDOW = 16;
+
+struct RedisLrangeBindData : public RedisScanBindData {
+	// LRANGE bounds as given: inclusive, negative counts from the end of the list
+	int64_t start = 0;
+	int64_t stop = -1;
+	// Pushed down by RedisLrangePushdown: absolute idx bounds of WHERE filters, and LIMIT + OFFSET (-1: none).
+	int64_t idx_min = 0;
+	int64_t idx_max = NumericLimits<int64_t>::Maximum();
+	int64_t row_limit = -1;
+
+	using RedisScanBindData::RedisScanBindData;
+
+	// Negative bounds other than stop = -1 (the end) need the length of each list.
+	bool NeedsLength() const {
+		return start < 0 || stop < -1;
+	}
+
+	unique_ptr<FunctionData> Copy() const override {
+		return make_uniq<RedisLrangeBindData>(*this);
+	}
+
+	bool Equals(const FunctionData &other_p) const override {
+		auto &other = other_p.Cast<RedisLrangeBindData>();
+		return RedisScanBindData::Equals(other_p) && start == other.start && stop == other.stop &&
+		       idx_min == other.idx_min && idx_max == other.idx_max && row_limit == other.row_limit;
+	}
+};
+
+// One list of the current SCAN page and the part of it still to be read.
+struct RedisListCursor {
+	std::string_view key;
+	int64_t next;
+	// Last index to read (inclusive); NumericLimits<int64_t>::Maximum() reads until a window comes back short.
+	int64_t last;
+
+	bool Done() const {
+		return next > last;
+	}
+};
+
+struct RedisListRow {
+	idx_t list;
+	int64_t idx;
+	std::string_view value;
+};
+
+struct RedisLrangeGlobalState : public RedisScanGlobalState {
+	std::vector<RedisListCursor> lists;
+	// Keys of 'lists' point into key_segments (nullptr for a single key, which lives in the bind data).
+	buffer_ptr<RedisSegmentBuffer> key_segments;
+
+	// Elements of the last round of windows, pinned by value_segments.
+	std::vector<RedisListRow> rows;
+	buffer_ptr<RedisSegmentBuffer> value_segments;
+	idx_t row_pos = 0;
+};
+
+static bool IsGlobPattern(const std::string &pattern) {
+	return pattern.find_first_of("*?[\\") != std::string::npos;
+}
+
+// The indexes of a list of 'length' elements (unknown: -1) this query reads.
+static RedisListCursor ResolveListRange(const RedisLrangeBindData &bind, std::string_view key, int64_t length) {
+	constexpr auto MAX = NumericLimits<int64_t>::Maximum();
+	int64_t first = bind.start;
+	int64_t last = bind.stop == -1 ? MAX : bind.stop;
+	if (length >= 0) {
+		first = first < 0 ? MaxValue<int64_t>(length + first, 0) : first;
+		last = bind.stop < 0 ? length + bind.stop : MinValue<int64_t>(bind.stop, length - 1);
+	}
+	first = MaxValue(first, bind.idx_min);
+	last = MinValue(last, bind.idx_max);
+	// under LIMIT n no list contributes more than its first n rows
+	if (bind.row_limit >= 0 && first <= last && last - first >= bind.row_limit) {
+		last = first + bind.row_limit - 1;
+	}
+	return {key, first, last};
+}
+
+// LLEN for every list of the page; keys that are not lists (WRONGTYPE) are skipped.
+static void ResolveListLengths(RedisLrangeGlobalState &state, const RedisLrangeBindData &bind) {
+	PipelineOnNode(
+	    "redis_lrange", state, state.lists.size(),
+	    [&](RespEncoder &encoder) {
+		    for (auto &list : state.lists) {
+			    encoder.EncodeKeyCommand(resp::LLEN_PREFIX.View(), list.key);
+		    }
+	    },
+	    [&](const RespTape &replies, RedisClient &) {
+		    for (idx_t i = 0; i < state.lists.size(); i++) {
+			    auto length = replies[i].type == RespType::INT ? replies[i].int_val : 0;
+			    state.lists[i] = ResolveListRange(bind, state.lists[i].key, length);
+		    }
+	    });
+}
+
+/*
+  Reads the next round of windows into state.rows.
+    - One LRANGE per unfinished list of the page, all in one pipeline. Windows are the round budget split
+      over those lists (at least LRANGE_MIN_WINDOW), so short lists finish in the first round and the
+      windows of long ones grow as the others drop out.
+    - A list is done once its window reaches 'last' or comes back short; keys that are not lists are skipped.
+    - Moves on to the next SCAN page (FetchNextBatch) when every list of this one is done.
+    - Returns false once there is nothing left to read.
+*/
+static bool FetchListRows(RedisLrangeGlobalState &state, const RedisLrangeBindData &bind) {
+	state.rows.clear();
+	state.row_pos = 0;
+	state.value_segments.reset();
+
+	std::vector<idx_t> active;
+	for (idx_t i = 0; i < state.lists.size(); i++) {
+		if (!state.lists[i].Done()) {
+			active.push_back(i);
+		}
+	}
+	if (active.empty()) {
+		state.lists.clear();
+		state.key_segments.reset();
+		if (state.done) {
+			return false;
+		}
+		FetchNextBatch(state, bind.pattern);
+		for (auto &key : state.batch_keys) {
+			state.lists.push_back(ResolveListRange(bind, key, -1));
+		}
+		state.key_segments = state.batch_segments;
+		state.batch_keys.clear();
+		state.batch_segments.reset();
+		if (bind.NeedsLength() && !state.lists.empty()) {
+			ResolveListLengths(state, bind);
+		}
+		return true;
+	}
+
+	int64_t budget = LRANGE_ROUND_ELEMENTS;
+	if (bind.row_limit >= 0) {
+		budget = MinValue<int64_t>(budget, MaxValue<int64_t>(bind.row_limit, 1));
+	}
+	// every unfinished list gets a window, so a small LIMIT still reads a page in one round trip
+	int64_t window = MaxValue<int64_t>(budget / static_cast<int64_t>(active.size()), LRANGE_MIN_WINDOW);
+
+	std::vector<int64_t> requested(active.size());
+	PipelineOnNode(
+	    "redis_lrange", state, active.size(),
+	    [&](RespEncoder &encoder) {
+		    for (idx_t i = 0; i < active.size(); i++) {
+			    auto &list = state.lists[active[i]];
+			    auto to = list.last - list.next < window ? list.last : list.next + window - 1;
+			    requested[i] = to - list.next + 1;
+			    encoder.EncodeRange(resp::LRANGE_PREFIX.View(), list.key, list.next, to);
+		    }
+	    },
+	    [&](const RespTape &replies, RedisClient &client) {
+		    for (idx_t i = 0; i < active.size(); i++) {
+			    auto &list = state.lists[active[i]];
+			    auto &reply = replies[i];
+			    if (reply.type != RespType::ARRAY) {
+				    list.next = list.last + 1;
+				    continue;
+			    }
+			    for (auto &element : reply.children) {
+				    state.rows.push_back({active[i], list.next++, element.AsString()});
+			    }
+			    if (static_cast<int64_t>(reply.children.size()) < requested[i]) {
+				    list.next = list.last + 1;
+			    }
+		    }
+		    state.value_segments = make_buffer<RedisSegmentBuffer>(client.ReceiveSegments());
+	    });
+	return true;
+}
+
+static unique_ptr<FunctionData> RedisLrangeBind(ClientContext &context, TableFunctionBindInput &input,
+                                                vector<LogicalType> &return_types, vector<string> &names) {
+	for (auto &argument : input.inputs) {
+		if (argument.IsNull()) {
+			throw InvalidInputException("redis_lrange(pattern_or_key, start, stop) arguments cannot be NULL");
+		}
+	}
+	auto result = make_uniq<RedisLrangeBindData>(input.inputs[0].GetValue<std::string>());
+	if (input.inputs.size() == 3) {
+		result->start = input.inputs[1].GetValue<int64_t>();
+		result->stop = input.inputs[2].GetValue<int64_t>();
+	}
+	BindScanParameters(context, input, *result);
+
+	return_types.push_back(LogicalType::VARCHAR);
+	names.push_back("key_name");
+	return_types.push_back(LogicalType::BIGINT);
+	names.push_back("idx");
+	return_types.push_back(LogicalType::VARCHAR);
+	names.push_back("value");
+	return std::move(result);
+}
+
+static unique_ptr<GlobalTableFunctionState> RedisLrangeInit(ClientContext &, TableFunctionInitInput &input) {
+	auto &bind = input.bind_data->Cast<RedisLrangeBindData>();
+	auto state = make_uniq<RedisLrangeGlobalState>();
+	state->route = bind.route;
+	state->node = redis_router.PickScanNode(*state->route);
+
+	// a plain key is read directly, without walking the keyspace for it
+	if (!IsGlobPattern(bind.pattern)) {
+		state->done = true;
+		state->lists.push_back(ResolveListRange(bind, bind.pattern, -1));
+		if (bind.NeedsLength()) {
+			ResolveListLengths(*state, bind);
+		}
+	}
+	return std::move(state);
+}
+
+static void RedisLrangeFunc(ClientContext &, TableFunctionInput &data_p, DataChunk &output) {
+	auto &bind = data_p.bind_data->Cast<RedisLrangeBindData>();
+	auto &state = data_p.global_state->Cast<RedisLrangeGlobalState>();
+
+	while (state.row_pos >= state.rows.size()) {
+		if (!FetchListRows(state, bind)) {
+			output.SetCardinality(0);
+			return;
+		}
+	}
+
+	idx_t count = MinValue<idx_t>(STANDARD_VECTOR_SIZE, state.rows.size() - state.row_pos);
+	auto keys = FlatVector::GetData<string_t>(output.data[0]);
+	auto indexes = FlatVector::GetData<int64_t>(output.data[1]);
+	auto values = FlatVector::GetData<string_t>(output.data[2]);
+	for (idx_t i = 0; i < count; i++) {
+		auto &row = state.rows[state.row_pos + i];
+		auto key = state.lists[row.list].key;
+		keys[i] = state.key_segments ? SegmentString(key) : StringVector::AddString(output.data[0], key.data(), key.size());
+		indexes[i] = row.idx;
+		values[i] = SegmentString(row.value);
+	}
+	if (state.key_segments) {
+		StringVector::AddBuffer(output.data[0], state.key_segments);
+	}
+	StringVector::AddBuffer(output.data[2], state.value_segments);
+	state.row_pos += count;
+	output.SetCardinality(count);
+}
+
+static InsertionOrderPreservingMap<string> RedisLrangeToString(TableFunctionToStringInput &input) {
+	InsertionOrderPreservingMap<string> result;
+	auto &bind = input.bind_data->Cast<RedisLrangeBindData>();
+	result["Pattern"] = bind.pattern;
+	result["Range"] = StringUtil::Format("%lld..%lld", (long long)bind.start, (long long)bind.stop);
+	if (bind.idx_min > 0 || bind.idx_max < NumericLimits<int64_t>::Maximum()) {
+		result["Pushed idx"] = StringUtil::Format("%lld..%lld", (long long)bind.idx_min, (long long)bind.idx_max);
+	}
+	if (bind.row_limit >= 0) {
+		result["Pushed Limit"] = std::to_string(bind.row_limit);
+	}
+	return result;
+}
+
+// Narrows [idx_min, idx_max] by one filter of the form idx <op> constant; other filters are ignored.
+static void NarrowIdxRange(Expression &filter, LogicalGet &get, RedisLrangeBindData &bind) {
+	if (filter.GetExpressionClass() != ExpressionClass::BOUND_COMPARISON) {
+		return;
+	}
+	auto &comparison = filter.Cast<BoundComparisonExpression>();
+	auto type = comparison.GetExpressionType();
+	Expression *column = comparison.left.get();
+	Expression *constant = comparison.right.get();
+	if (column->GetExpressionClass() == ExpressionClass::BOUND_CONSTANT) {
+		std::swap(column, constant);
+		type = FlipComparisonExpression(type);
+	}
+	auto column_id = ScanColumn(*column, get);
+	if (!column_id.IsValid() || column_id.GetIndex() != 1 ||
+	    constant->GetExpressionClass() != ExpressionClass::BOUND_CONSTANT) {
+		return;
+	}
+	auto &value = constant->Cast<BoundConstantExpression>().value;
+	if (value.IsNull() || !value.type().IsIntegral()) {
+		return;
+	}
+	auto bound = value.GetValue<int64_t>();
+	switch (type) {
+	case ExpressionType::COMPARE_EQUAL:
+		bind.idx_min = MaxValue(bind.idx_min, bound);
+		bind.idx_max = MinValue(bind.idx_max, bound);
+		break;
+	case ExpressionType::COMPARE_GREATERTHANOREQUALTO:
+		bind.idx_min = MaxValue(bind.idx_min, bound);
+		break;
+	case ExpressionType::COMPARE_GREATERTHAN:
+		if (bound < NumericLimits<int64_t>::Maximum()) {
+			bind.idx_min = MaxValue(bind.idx_min, bound + 1);
+		}
+		break;
+	case ExpressionType::COMPARE_LESSTHANOREQUALTO:
+		bind.idx_max = MinValue(bind.idx_max, bound);
+		break;
+	case ExpressionType::COMPARE_LESSTHAN:
+		if (bound > NumericLimits<int64_t>::Minimum()) {
+			bind.idx_max = MinValue(bind.idx_max, bound - 1);
+		}
+		break;
+	default:
+		break;
+	}
+}
+
+/*
+  Pushes into redis_lrange:
+    - WHERE filters on idx (comparisons with constants) as bounds of the LRANGE windows. The filters stay
+      in the plan; the windows just never cover elements they would remove.
+    - LIMIT n [OFFSET m] directly above the scan (projections in between are fine, filters are not): no
+      list needs more than its first n + m elements.
+*/
+static void RedisLrangePushdown(OptimizerExtensionInput &input, unique_ptr<LogicalOperator> &plan) {
+	for (auto &child : plan->children) {
+		RedisLrangePushdown(input, child);
+	}
+	if (plan->children.size() != 1) {
+		return;
+	}
+	bool is_limit = plan->type == LogicalOperatorType::LOGICAL_LIMIT;
+	if (!is_limit && plan->type != LogicalOperatorType::LOGICAL_FILTER) {
+		return;
+	}
+	LogicalOperator *op = plan->children[0].get();
+	while (is_limit && op->type == LogicalOperatorType::LOGICAL_PROJECTION && op->children.size() == 1) {
+		op = op->children[0].get();
+	}
+	if (op->type != LogicalOperatorType::LOGICAL_GET) {
+		return;
+	}
+	auto &get = op->Cast<LogicalGet>();
+	if (get.function.name != "redis_lrange" || !get.bind_data) {
+		return;
+	}
+	auto &bind = get.bind_data->Cast<RedisLrangeBindData>();
+
+	if (!is_limit) {
+		for (auto &filter : plan->expressions) {
+			NarrowIdxRange(*filter, get, bind);
+		}
+		return;
+	}
+	auto &limit = plan->Cast<LogicalLimit>();
+	if (limit.limit_val.Type() != LimitNodeType::CONSTANT_VALUE ||
+	    (limit.offset_val.Type() != LimitNodeType::CONSTANT_VALUE && limit.offset_val.Type() != LimitNodeType::UNSET)) {
+		return;
+	}
+	auto rows = limit.limit_val.GetConstantValue();
+	if (limit.offset_val.Type() == LimitNodeType::CONSTANT_VALUE) {
+		rows += limit.offset_val.GetConstantValue();
+	}
+	if (rows < static_cast<idx_t>(NumericLimits<int64_t>::Maximum())) {
+		auto pushed = static_cast<int64_t>(rows);
+		bind.row_limit = bind.row_limit < 0 ? pushed : MinValue(bind.row_limit, pushed);
+	}
+}
+
+// -------------------------------------------------------------------------------------------------
+//  Bitmaps: redis_bitmap(key_or_pattern) rows, redis_bitmap_count() and the AND / OR aggregates
+// -------------------------------------------------------------------------------------------------
+
+// Bitmap bytes requested per round trip: enough to stream at network speed, few enough to bound the read-ahead.
+static constexpr int64_t BITMAP_ROUND_BYTES = 1 << 20;
+// Round size while memory is under pressure.
+static constexpr int64_t PRESSURE_BITMAP_ROUND_BYTES = 64 * 1024;
+// Smallest GETRANGE of a round, so one round covers at most ROUND_BYTES / MIN_CHUNK_BYTES bitmaps.
+static constexpr int64_t BITMAP_MIN_CHUNK_BYTES = 16 * 1024;
+
+/*
+  One pipeline of GETRANGEs: a chunk of 'length' bytes of each of several bitmaps.
+    - keys point into the SCAN pages pinned by key_pins, or into the bind data for a single key (no pins).
+    - Once the replies are read, chunks point into the receive segments pinned by 'segments'; keys that are
+      not strings (WRONGTYPE) and missing keys read as empty chunks.
+*/
+struct BitmapRound {
+	std::vector<std::string_view> keys;
+	std::vector<int64_t> from;
+	int64_t length = 0;
+	std::vector<buffer_ptr<RedisSegmentBuffer>> key_pins;
+	std::vector<std::string_view> chunks;
+	std::vector<SegmentRef> segments;
+
+	idx_t Size() const {
+		return keys.size();
+	}
+};
+
+struct RedisBitmapGlobalState : public RedisScanGlobalState {
+	// Keys of the current SCAN page (pinned by key_segments; nullptr for a single key from the bind data).
+	std::vector<std::string_view> bitmap_keys;
+	buffer_ptr<RedisSegmentBuffer> key_segments;
+	idx_t next_key = 0;
+
+	// The round being decoded: chunk round_pos, from byte chunk_pos on.
+	BitmapRound round;
+	idx_t round_pos = 0;
+	size_t chunk_pos = 0;
+
+	// The round after it, already sent on bitmap_client while this one is decoded (unless next_sent is false).
+	BitmapRound next;
+	bool next_sent = false;
+	unique_ptr<PooledClient> bitmap_client;
+	RespParser bitmap_parser;
+};
+
+/*
+  Plans 'next': the bitmaps of the current round whose chunk came back full, then new keys of the page
+  (FetchNextBatch for the next SCAN page once this one is used up and nothing else is left).
+    - The round budget is split evenly over its keys, so a page of small bitmaps is read in one round trip
+      and a single large one in chunks of the whole budget.
+    - Returns false once every key has been read.
+*/
+static bool PlanBitmapRound(RedisBitmapGlobalState &state, const RedisScanBindData &bind) {
+	auto &round = state.round;
+	auto &next = state.next;
+	next = BitmapRound();
+	int64_t budget = TransportMemory::Instance().UnderPressure() ? PRESSURE_BITMAP_ROUND_BYTES : BITMAP_ROUND_BYTES;
+	idx_t max_keys = static_cast<idx_t>(budget / BITMAP_MIN_CHUNK_BYTES);
+
+	for (idx_t i = 0; i < round.chunks.size(); i++) {
+		if (static_cast<int64_t>(round.chunks[i].size()) == round.length) {
+			next.keys.push_back(round.keys[i]);
+			next.from.push_back(round.from[i] + round.length);
+		}
+	}
+	if (!next.keys.empty()) {
+		next.key_pins = round.key_pins;
+	}
+	while (next.Size() < max_keys) {
+		if (state.next_key >= state.bitmap_keys.size()) {
+			if (state.done || !next.keys.empty()) {
+				break;
+			}
+			FetchNextBatch(state, bind.pattern);
+			state.bitmap_keys = state.batch_keys;
+			state.key_segments = state.batch_segments;
+			state.batch_keys.clear();
+			state.batch_segments.reset();
+			state.next_key = 0;
+			continue;
+		}
+		if (state.key_segments &&
+		    std::find(next.key_pins.begin(), next.key_pins.end(), state.key_segments) == next.key_pins.end()) {
+			next.key_pins.push_back(state.key_segments);
+		}
+		next.keys.push_back(state.bitmap_keys[state.next_key++]);
+		next.from.push_back(0);
+	}
+	if (next.keys.empty()) {
+		return false;
+	}
+	next.length = MaxValue<int64_t>(budget / static_cast<int64_t>(next.Size()), BITMAP_MIN_CHUNK_BYTES);
+	return true;
+}
+
+// Sends 'next' on the bitmap client, leasing one if needed; a failed send is retried by ReadBitmapRound.
+static void SendBitmapRound(RedisBitmapGlobalState &state) {
+	auto &next = state.next;
+	state.next_sent = false;
+	try {
+		if (!state.bitmap_client) {
+			state.bitmap_client = LeaseClient(state.node, state.route->policy);
+		}
+		RespEncoder encoder;
+		for (idx_t i = 0; i < next.Size(); i++) {
+			encoder.EncodeRange(resp::GETRANGE_PREFIX.View(), next.keys[i], next.from[i], next.from[i] + next.length - 1);
+		}
+		state.next_sent = (*state.bitmap_client)->SendEncoded(encoder);
+	} catch (Exception &) {
+		throw;
+	} catch (std::runtime_error &) {
+		// unreachable right now: counted as a failed attempt when the round is read
+	}
+	if (!state.next_sent) {
+		state.bitmap_client.reset();
+	}
+}
+
+/*
+  Reads the replies of 'next' and makes it the current round.
+    - GETRANGE is read-only: a round whose connection fails is sent again on a new one, up to policy.retries times.
+*/
+static void ReadBitmapRound(RedisBitmapGlobalState &state) {
+	auto &next = state.next;
+	for (int64_t attempt = 0;; attempt++) {
+		std::string error = "send to " + state.node->endpoint.ToString() + " failed";
+		if (state.next_sent) {
+			try {
+				auto &client = **state.bitmap_client;
+				client.ReadReplies(state.bitmap_parser, next.Size());
+				auto &replies = state.bitmap_parser.Objects();
+				for (idx_t i = 0; i < next.Size(); i++) {
+					next.chunks.push_back(replies[i].type == RespType::BULK_STRING ? replies[i].AsString()
+					                                                                : std::string_view());
+				}
+				next.segments = client.ReceiveSegments();
+				state.bitmap_parser.ClearObjects();
+				client.ClearBuffer();
+
+				state.round = std::move(next);
+				state.next = BitmapRound();
+				state.next_sent = false;
+				state.round_pos = 0;
+				state.chunk_pos = 0;
+				return;
+			} catch (Exception &) {
+				throw;
+			} catch (std::runtime_error &ex) {
+				error = ex.what();
+			}
+		}
+		redis_router.MarkFailed(state.node);
+		state.bitmap_parser.ClearObjects();
+		state.bitmap_client.reset();
+		next.chunks.clear();
+		if (attempt >= state.route->policy.retries) {
+			throw IOException("redis_bitmap: %s", error);
+		}
+		SendBitmapRound(state);
+	}
+}
+
+/*
+  Moves on to the next round of GETRANGEs, pipelined over the keys of a SCAN page.
+    - The round after it is sent before this one is decoded, so the server and the network work on the next
+      chunks while the offsets of these are written out.
+    - Returns false once every key has been read.
+*/
+static bool NextBitmapRound(RedisBitmapGlobalState &state, const RedisScanBindData &bind) {
+	if (!state.next_sent && state.next.keys.empty()) {
+		// nothing in flight: the first round, or the end
+		if (!PlanBitmapRound(state, bind)) {
+			return false;
+		}
+		SendBitmapRound(state);
+	}
+	ReadBitmapRound(state);
+	if (PlanBitmapRound(state, bind)) {
+		SendBitmapRound(state);
+	}
+	return true;
+}
+
+static unique_ptr<FunctionData> RedisBitmapBind(ClientContext &context, TableFunctionBindInput &input,
+                                                vector<LogicalType> &return_types, vector<string> &names) {
+	if (input.inputs.size() != 1 || input.inputs[0].IsNull()) {
+		throw InvalidInputException("redis_bitmap(key_or_pattern) expects one non-NULL argument");
+	}
+	auto result = make_uniq<RedisScanBindData>(input.inputs[0].GetValue<std::string>());
+	BindScanParameters(context, input, *result);
+
+	return_types.push_back(LogicalType::VARCHAR);
+	names.push_back("key_name");
+	return_types.push_back(LogicalType::BIGINT);
+	names.push_back("offset");
+	return std::move(result);
+}
+
+static unique_ptr<GlobalTableFunctionState> RedisBitmapInit(ClientContext &, TableFunctionInitInput &input) {
+	auto &bind = input.bind_data->Cast<RedisScanBindData>();
+	auto state = make_uniq<RedisBitmapGlobalState>();
+	state->route = bind.route;
+	state->node = redis_router.PickScanNode(*state->route);
+	// a plain key is read directly, without walking the keyspace for it
+	if (!IsGlobPattern(bind.pattern)) {
+		state->done = true;
+		state->bitmap_keys.push_back(bind.pattern);
+	}
+	return std::move(state);
+}
+
+/*
+  One output chunk holds the offsets of one bitmap, so key_name is a constant vector.
+  Offsets are decoded straight into the output vector (see DecodeSetBits).
+*/
+static void RedisBitmapFunc(ClientContext &, TableFunctionInput &data_p, DataChunk &output) {
+	auto &bind = data_p.bind_data->Cast<RedisScanBindData>();
+	auto &state = data_p.global_state->Cast<RedisBitmapGlobalState>();
+
+	auto &round = state.round;
+	idx_t count = 0;
+	while (count == 0) {
+		if (state.round_pos >= round.Size()) {
+			if (!NextBitmapRound(state, bind)) {
+				output.SetCardinality(0);
+				return;
+			}
+			continue;
+		}
+		auto chunk = round.chunks[state.round_pos];
+		if (state.chunk_pos >= chunk.size()) {
+			state.round_pos++;
+			state.chunk_pos = 0;
+			continue;
+		}
+		size_t consumed;
+		count = DecodeSetBits(chunk.data() + state.chunk_pos, chunk.size() - state.chunk_pos,
+		                      (round.from[state.round_pos] + static_cast<int64_t>(state.chunk_pos)) * 8,
+		                      FlatVector::GetData<int64_t>(output.data[1]), STANDARD_VECTOR_SIZE, consumed);
+		state.chunk_pos += consumed;
+	}
+
+	auto &key_vector = output.data[0];
+	auto key = round.keys[state.round_pos];
+	key_vector.SetVectorType(VectorType::CONSTANT_VECTOR);
+	if (round.key_pins.empty()) {
+		ConstantVector::GetData<string_t>(key_vector)[0] = StringVector::AddString(key_vector, key.data(), key.size());
+	} else {
+		ConstantVector::GetData<string_t>(key_vector)[0] = SegmentString(key);
+		for (auto &pin : round.key_pins) {
+			StringVector::AddBuffer(key_vector, pin);
+		}
+	}
+	output.SetCardinality(count);
+}
+
+// redis_bitmap_count(bitmap): set bits of a BLOB, as BITCOUNT, counted locally.
+inline void BitmapCountScalarFun(DataChunk &args, ExpressionState &, Vector &result) {
+	UnaryExecutor::Execute<string_t, int64_t>(args.data[0], result, args.size(), [&](string_t bitmap) {
+		return static_cast<int64_t>(CountSetBits(bitmap.GetData(), bitmap.GetSize()));
+	});
+}
+
+struct BitmapAggregateState {
+	// nullptr until the first non-NULL bitmap
+	std::vector<char> *bits;
+};
+
+/*
+  redis_bitmap_and / redis_bitmap_or: BITOP AND / OR over all bitmaps of a group, computed locally.
+    - As with BITOP, shorter bitmaps count as zero-padded, so the result is as long as the longest input.
+*/
+template <bool IS_AND>
+struct BitmapCombineOperation {
+	template <class STATE>
+	static void Initialize(STATE &state) {
+		state.bits = nullptr;
+	}
+
+	static void Apply(BitmapAggregateState &state, const char *data, idx_t size) {
+		if (!state.bits) {
+			state.bits = new std::vector<char>(data, data + size);
+			return;
+		}
+		auto &bits = *state.bits;
+		auto common = MinValue<idx_t>(bits.size(), size);
+		if (IS_AND) {
+			AndBitmaps(bits.data(), data, common);
+			std::fill(bits.begin() + static_cast<std::ptrdiff_t>(common), bits.end(), 0);
+			bits.resize(MaxValue<idx_t>(bits.size(), size), 0);
+		} else {
+			OrBitmaps(bits.data(), data, common);
+			bits.insert(bits.end(), data + common, data + size);
+		}
+	}
+
+	template <class INPUT_TYPE, class STATE, class OP>
+	static void Operation(STATE &state, const INPUT_TYPE &input, AggregateUnaryInput &) {
+		Apply(state, input.GetData(), input.GetSize());
+	}
+
+	template <class INPUT_TYPE, class STATE, class OP>
+	static void ConstantOperation(STATE &state, const INPUT_TYPE &input, AggregateUnaryInput &unary_input, idx_t) {
+		// x AND x = x OR x = x
+		Operation<INPUT_TYPE, STATE, OP>(state, input, unary_input);
+	}
+
+	template <class STATE, class OP>
+	static void Combine(const STATE &source, STATE &target, AggregateInputData &) {
+		if (source.bits) {
+			Apply(target, source.bits->data(), source.bits->size());
+		}
+	}
+
+	template <class T, class STATE>
+	static void Finalize(STATE &state, T &target, AggregateFinalizeData &finalize_data) {
+		if (!state.bits) {
+			finalize_data.ReturnNull();
+			return;
+		}
+		target = StringVector::AddStringOrBlob(finalize_data.result, state.bits->data(), state.bits->size());
+	}
+
+	template <class STATE>
+	static void Destroy(STATE &state, AggregateInputData &) {
+		delete state.bits;
+		state.bits = nullptr;
+	}
+
+	static bool IgnoreNull() {
+		return true;
+	}
+};
+
+template <bool IS_AND>
+static AggregateFunction BitmapCombineAggregate(const string &name) {
+	auto function = AggregateFunction::UnaryAggregateDestructor<BitmapAggregateState, string_t, string_t,
+	                                                            BitmapCombineOperation<IS_AND>>(LogicalType::BLOB,
+	                                                                                            LogicalType::BLOB);
+	function.name = name;
+	return function;
+}
+
+// -------------------------------------------------------------------------------------------------
+//  redis_memory(): current and peak transport memory, next to duckdb_memory()
+// -------------------------------------------------------------------------------------------------
+
+struct RedisMemoryGlobalState : public GlobalTableFunctionState {
+	bool done = false;
+};
+
+static unique_ptr<FunctionData> RedisMemoryBind(ClientContext &, TableFunctionBindInput &, vector<LogicalType> &return_types,
+                                                vector<string> &names) {
+	return_types.push_back(LogicalType::VARCHAR);
+	names.push_back("component");
+	return_types.push_back(LogicalType::BIGINT);
+	names.push_back("memory_usage_bytes");
+	return_types.push_back(LogicalType::BIGINT);
+	names.push_back("peak_memory_usage_bytes");
+	return nullptr;
+}
+
+static unique_ptr<GlobalTableFunctionState> RedisMemoryInit(ClientContext &, TableFunctionInitInput &) {
+	return make_uniq<RedisMemoryGlobalState>();
+}
+
+static void RedisMemoryFunc(ClientContext &, TableFunctionInput &data_p, DataChunk &output) {
+	auto &state = data_p.global_state->Cast<RedisMemoryGlobalState>();
+	if (state.done) {
+		output.SetCardinality(0);
+		return;
+	}
+	state.done = true;
+
+	const std::pair<const char *, MemoryComponent> components[] = {
+	    {"receive_segments", MemoryComponent::SEGMENTS},
+	    {"idle_segments", MemoryComponent::IDLE_SEGMENTS},
+	    {"parser_tapes", MemoryComponent::TAPES},
+	};
+	idx_t row = 0;
+	for (auto &component : components) {
+		auto usage = TransportMemory::Instance().Usage(component.second);
+		output.SetValue(0, row, Value(component.first));
+		output.SetValue(1, row, Value::BIGINT(usage.bytes));
+		output.SetValue(2, row, Value::BIGINT(usage.peak_bytes));
+		row++;
+	}
+	output.SetCardinality(row);
+}
+
+// -------------------------------------------------------------------------------------------------
+//  ATTACH 'redis://host:port' AS r (TYPE redis): key prefixes as views with inferred, cached schemas
+// -------------------------------------------------------------------------------------------------
+
+// Keys SCANned at ATTACH to find prefixes and estimate their sizes (sample_keys := N).
+static constexpr idx_t DEFAULT_ATTACH_SAMPLE_KEYS = 10000;
+// Keys per prefix whose type and contents decide the table's schema.
+static constexpr idx_t SCHEMA_SAMPLE_KEYS = 16;
+// Hash fields beyond this many (in order of first appearance) are not given columns.
+static constexpr idx_t MAX_HASH_COLUMNS = 64;
+
+// One table of an attached Redis: the keys "<name>:*".
+struct RedisAttachedTable {
+	string name;
+	int64_t estimated_keys = 0;
+	vector<string> sample_keys;
+	// majority TYPE of the sampled keys
+	string redis_type;
+	// string keys: type of the value column
+	RedisValueType value_type = RedisValueType::VARCHAR;
+	// hash keys: one column per field
+	vector<string> fields;
+	vector<LogicalType> field_types;
+
+	string Pattern() const {
+		return name + ":*";
+	}
+};
+
+// The narrowest of BIGINT, DOUBLE and VARCHAR every sampled value converts to.
+static LogicalType InferValueType(const vector<string> &values) {
+	bool all_bigint = !values.empty();
+	bool all_double = !values.empty();
+	for (auto &value : values) {
+		int64_t bigint_value;
+		double double_value;
+		string_t text(value.data(), UnsafeNumericCast<uint32_t>(value.size()));
+		all_bigint = all_bigint && TryCast::Operation<string_t, int64_t>(text, bigint_value, true);
+		all_double = all_double && TryCast::Operation<string_t, double>(text, double_value, true);
+	}
+	return all_bigint ? LogicalType::BIGINT : all_double ? LogicalType::DOUBLE : LogicalType::VARCHAR;
+}
+
+// Sends one command per sample key (prefix + key) and returns the replies, which live until the next call.
+static const RespTape &SampleKeys(RedisClient &client, RespParser &parser, std::string_view prefix,
+                                  const vector<string> &keys) {
+	RespEncoder encoder;
+	parser.ClearObjects();
+	client.ClearBuffer();
+	for (auto &key : keys) {
+		encoder.EncodeKeyCommand(prefix, key);
+	}
+	if (!client.SendEncoded(encoder)) {
+		throw IOException("redis attach: send failed");
+	}
+	client.ReadReplies(parser, keys.size());
+	return parser.Objects();
+}
+
+/*
+  Finds the tables of an attached Redis and infers their schemas.
+    - Up to sample_keys keys are SCANned; their prefixes (up to the first ':') become tables, unless a list
+      of prefixes was configured. Sizes are extrapolated to DBSIZE unless the scan saw every key.
+    - Configured prefixes missing from the sample are looked up with their own SCAN MATCH.
+    - TYPE decides the kind of table; string values and hash fields are typed by GET / HGETALL of a few keys.
+*/
+static vector<RedisAttachedTable> DiscoverTables(RedisClient &client, const vector<string> &prefixes,
+                                                 idx_t sample_keys) {
+	RespParser parser;
+	const RespObject &size_reply = client.RunCommand({"DBSIZE"}, parser);
+	int64_t total_keys = size_reply.type == RespType::INT ? size_reply.int_val : 0;
+
+	std::map<string, RedisAttachedTable> tables;
+	for (auto &prefix : prefixes) {
+		tables[prefix].name = prefix;
+	}
+	idx_t scanned = 0;
+	string cursor = "0";
+	bool complete = false;
+	while (scanned < sample_keys) {
+		const RespObject &reply = client.RunCommand({"SCAN", cursor, "COUNT", "1000"}, parser);
+		if (reply.type != RespType::ARRAY || reply.children.size() < 2) {
+			throw IOException("redis attach: unexpected SCAN reply");
+		}
+		cursor = string(reply.children[0].AsString());
+		for (auto &key_obj : reply.children[1].children) {
+			auto key = key_obj.AsString();
+			scanned++;
+			auto colon = key.find(':');
+			// keys without a prefix (":x" included) belong to no table
+			if (colon == std::string_view::npos || colon == 0) {
+				continue;
+			}
+			string prefix(key.substr(0, colon));
+			if (!prefixes.empty() && !tables.count(prefix)) {
+				continue;
+			}
+			auto &table = tables[prefix];
+			table.name = prefix;
+			table.estimated_keys++;
+			if (table.sample_keys.size() < SCHEMA_SAMPLE_KEYS) {
+				table.sample_keys.emplace_back(key);
+			}
+		}
+		if (cursor == "0") {
+			complete = true;
+			break;
+		}
+	}
+
+	vector<RedisAttachedTable> result;
+	for (auto &entry : tables) {
+		auto &table = entry.second;
+		if (!complete && scanned > 0) {
+			table.estimated_keys = int64_t(double(table.estimated_keys) * double(total_keys) / double(scanned));
+		}
+		// a configured prefix the sample missed
+		for (string prefix_cursor = "0"; table.sample_keys.empty();) {
+			const RespObject &reply =
+			    client.RunCommand({"SCAN", prefix_cursor, "MATCH", table.Pattern(), "COUNT", "1000"}, parser);
+			if (reply.type != RespType::ARRAY || reply.children.size() < 2) {
+				throw IOException("redis attach: unexpected SCAN reply");
+			}
+			prefix_cursor = string(reply.children[0].AsString());
+			for (auto &key_obj : reply.children[1].children) {
+				if (table.sample_keys.size() < SCHEMA_SAMPLE_KEYS) {
+					table.sample_keys.emplace_back(key_obj.AsString());
+				}
+			}
+			if (prefix_cursor == "0") {
+				break;
+			}
+		}
+		if (table.sample_keys.empty()) {
+			// no keys at all: an empty table of keys
+			table.redis_type = "none";
+			result.push_back(std::move(table));
+			continue;
+		}
+
+		std::map<string, idx_t> type_counts;
+		for (auto &reply : SampleKeys(client, parser, resp::TYPE_PREFIX.View(), table.sample_keys)) {
+			type_counts[string(reply.AsString())]++;
+		}
+		table.redis_type = std::max_element(type_counts.begin(), type_counts.end(), [](auto &a, auto &b) {
+			                   return a.second < b.second;
+		                   })->first;
+
+		if (table.redis_type == "string") {
+			vector<string> values;
+			for (auto &reply : SampleKeys(client, parser, resp::GET_PREFIX.View(), table.sample_keys)) {
+				if (reply.type == RespType::BULK_STRING) {
+					values.emplace_back(reply.AsString());
+				}
+			}
+			auto type = InferValueType(values);
+			table.value_type = type.id() == LogicalTypeId::BIGINT   ? RedisValueType::BIGINT
+			                   : type.id() == LogicalTypeId::DOUBLE ? RedisValueType::DOUBLE
+			                                                        : RedisValueType::VARCHAR;
+		} else if (table.redis_type == "hash") {
+			// HGETALL: [field, value, field, value, ...]
+			vector<vector<string>> values;
+			for (auto &reply : SampleKeys(client, parser, resp::HGETALL_PREFIX.View(), table.sample_keys)) {
+				for (idx_t i = 0; i + 1 < reply.children.size(); i += 2) {
+					string field(reply.children[i].AsString());
+					auto position = std::find(table.fields.begin(), table.fields.end(), field);
+					if (position == table.fields.end()) {
+						if (table.fields.size() >= MAX_HASH_COLUMNS || field == "key_name") {
+							continue;
+						}
+						table.fields.push_back(field);
+						values.emplace_back();
+						position = table.fields.end() - 1;
+					}
+					values[position - table.fields.begin()].emplace_back(reply.children[i + 1].AsString());
+				}
+			}
+			for (auto &field_values : values) {
+				table.field_types.push_back(InferValueType(field_values));
+			}
+		}
+		result.push_back(std::move(table));
+	}
+	parser.ClearObjects();
+	client.ClearBuffer();
+	return result;
+}
+
+/*
+  The view behind an attached table; 'database' is the name the Redis is attached as (see AttachedNode).
+    - string keys:  SELECT key_name, value FROM redis_kv(...)
+    - hash keys:    SELECT key_name, <fields> FROM redis_hash_scan(...), numeric fields cast to their type
+    - other types:  SELECT key_name FROM redis_scan(...)
+  The column types are part of the view, so the server is not asked again when a query binds it.
+*/
+static unique_ptr<CreateViewInfo> AttachedTableView(const RedisAttachedTable &table, const string &database) {
+	auto info = make_uniq<CreateViewInfo>();
+	info->schema = DEFAULT_SCHEMA;
+	info->view_name = table.name;
+	info->on_conflict = OnCreateConflict::REPLACE_ON_CONFLICT;
+
+	auto arguments = KeywordHelper::WriteQuoted(table.Pattern(), '\'');
+	auto parameters = ", attached := " + KeywordHelper::WriteQuoted(database, '\'') +
+	                  ", estimated_keys := " + std::to_string(table.estimated_keys);
+	info->names.push_back("key_name");
+	info->types.push_back(LogicalType::VARCHAR);
+
+	string sql;
+	if (table.redis_type == "string") {
+		auto type = table.value_type == RedisValueType::BIGINT   ? "bigint"
+		            : table.value_type == RedisValueType::DOUBLE ? "double"
+		                                                         : "varchar";
+		sql = StringUtil::Format("SELECT key_name, value FROM redis_kv(%s, value_type := '%s'%s)", arguments, type,
+		                         parameters);
+		info->names.push_back("value");
+		info->types.push_back(ValueLogicalType(table.value_type));
+	} else if (table.redis_type == "hash" && !table.fields.empty()) {
+		string columns = "key_name";
+		string fields;
+		for (idx_t i = 0; i < table.fields.size(); i++) {
+			auto column = KeywordHelper::WriteOptionallyQuoted(table.fields[i]);
+			auto &type = table.field_types[i];
+			columns += ", ";
+			columns += type.id() == LogicalTypeId::VARCHAR
+			               ? column
+			               : StringUtil::Format("TRY_CAST(%s AS %s) AS %s", column, type.ToString(), column);
+			fields += (i == 0 ? "" : ", ") + KeywordHelper::WriteQuoted(table.fields[i], '\'');
+			info->names.push_back(table.fields[i]);
+			info->types.push_back(type);
+		}
+		sql = StringUtil::Format("SELECT %s FROM redis_hash_scan(%s, [%s]%s)", columns, arguments, fields, parameters);
+	} else {
+		sql = StringUtil::Format("SELECT key_name FROM redis_scan(%s%s)", arguments, parameters);
+	}
+
+	Parser parser;
+	parser.ParseQuery(sql);
+	info->query = unique_ptr_cast<SQLStatement, SelectStatement>(std::move(parser.statements[0]));
+	info->sql = sql;
+	return info;
+}
+
+/*
+  An in-memory DuckDB catalog that starts out with one view per discovered prefix.
+    - The views (and with them the inferred schemas and key counts) are built once, on ATTACH; DETACH and
+      ATTACH again to pick up new prefixes or fields.
+    - Reads go through the regular table functions, so they get the same pushdowns. The catalog owns the
+      node (connection pool) of its server, so DETACH closes the connections.
+    - The database is read-only once the views exist.
+*/
+class RedisCatalog : public DuckCatalog {
+public:
+	RedisCatalog(AttachedDatabase &db, const RedisEndpoint &endpoint, vector<RedisAttachedTable> tables_p)
+	    : DuckCatalog(db), node(ReplicaRouter::NewNode(endpoint)), tables(std::move(tables_p)) {
+	}
+
+	using DuckCatalog::Initialize;
+	void Initialize(bool load_builtin) override {
+		DuckCatalog::Initialize(load_builtin);
+		auto transaction = CatalogTransaction::GetSystemTransaction(GetDatabase());
+		auto &schema = GetSchema(transaction, DEFAULT_SCHEMA);
+		for (auto &table : tables) {
+			auto info = AttachedTableView(table, GetName());
+			schema.CreateView(transaction, *info);
+		}
+		tables.clear();
+		GetAttached().SetReadOnlyDatabase();
+	}
+
+	const RedisNodeRef &Node() const {
+		return node;
+	}
+
+private:
+	RedisNodeRef node;
+	vector<RedisAttachedTable> tables;
+};
+
+static RedisNodeRef AttachedNode(ClientContext &context, const string &name) {
+	auto database = DatabaseManager::Get(context).GetDatabase(context, name);
+	auto catalog = database ? dynamic_cast<RedisCatalog *>(&database->GetCatalog()) : nullptr;
+	if (!catalog) {
+		throw BinderException("No Redis is attached as \"%s\"", name);
+	}
+	return catalog->Node();
+}
+
+/*
+  Address and credentials of an attached Redis.
+    - The ATTACH path ('redis://host:port/db', 'rediss://...', 'unix://...'; may be empty with a secret)
+    - then a secret: SECRET name, or else the redis secret whose scope matches the path.
+*/
+static RedisEndpoint AttachEndpoint(ClientContext &context, AttachInfo &info) {
+	RedisEndpoint endpoint;
+	try {
+		if (!info.path.empty()) {
+			endpoint = ParseEndpoint(info.path);
+		}
+	} catch (std::invalid_argument &ex) {
+		throw InvalidInputException("Invalid Redis address (%s)", ex.what());
+	}
+
+	auto &secret_manager = SecretManager::Get(context);
+	auto transaction = CatalogTransaction::GetSystemCatalogTransaction(context);
+	unique_ptr<SecretEntry> named_secret;
+	SecretMatch match;
+	const BaseSecret *secret = nullptr;
+	auto option = info.options.find("secret");
+	if (option != info.options.end()) {
+		named_secret = secret_manager.GetSecretByName(transaction, option->second.ToString());
+		if (!named_secret) {
+			throw BinderException("Secret \"%s\" not found", option->second.ToString());
+		}
+		secret = named_secret->secret.get();
+	} else {
+		match = secret_manager.LookupSecret(transaction, info.path, "redis");
+		if (match.HasMatch()) {
+			secret = &match.GetSecret();
+		}
+	}
+	if (!secret) {
+		return endpoint;
+	}
+	auto &kv_secret = dynamic_cast<const KeyValueSecret &>(*secret);
+	Value value;
+	if (kv_secret.TryGetValue("host", value)) {
+		endpoint.host = value.ToString();
+	}
+	if (kv_secret.TryGetValue("port", value)) {
+		endpoint.port = value.GetValue<int32_t>();
+	}
+	if (kv_secret.TryGetValue("db", value)) {
+		endpoint.db = value.GetValue<int32_t>();
+	}
+	if (kv_secret.TryGetValue("tls", value)) {
+		endpoint.tls = BooleanValue::Get(value.DefaultCastAs(LogicalType::BOOLEAN));
+	}
+	if (kv_secret.TryGetValue("username", value)) {
+		endpoint.username = value.ToString();
+	}
+	if (kv_secret.TryGetValue("password", value)) {
+		endpoint.password = value.ToString();
+	}
+	return endpoint;
+}
+
+/*
+  ATTACH 'redis://host:port/db' AS r (TYPE redis [, SECRET name] [, PREFIXES 'user,session'] [, SAMPLE_KEYS n])
+*/
+static unique_ptr<Catalog> RedisAttach(optional_ptr<StorageExtensionInfo>, ClientContext &context, AttachedDatabase &db,
+                                       const string &, AttachInfo &info, AttachOptions &) {
+	auto endpoint = AttachEndpoint(context, info);
+
+	vector<string> prefixes;
+	auto option = info.options.find("prefixes");
+	if (option != info.options.end() && !option->second.IsNull()) {
+		vector<string> items;
+		if (option->second.type().id() == LogicalTypeId::LIST) {
+			for (auto &item : ListValue::GetChildren(option->second)) {
+				items.push_back(item.ToString());
+			}
+		} else {
+			items = StringUtil::Split(option->second.ToString(), ',');
+		}
+		for (auto &item : items) {
+			StringUtil::Trim(item);
+			// 'user:*' and 'user' name the same table
+			if (StringUtil::EndsWith(item, ":*")) {
+				item = item.substr(0, item.size() - 2);
+			}
+			if (!item.empty()) {
+				prefixes.push_back(item);
+			}
+		}
+	}
+	idx_t sample_keys = DEFAULT_ATTACH_SAMPLE_KEYS;
+	option = info.options.find("sample_keys");
+	if (option != info.options.end() && !option->second.IsNull()) {
+		sample_keys = option->second.GetValue<uint64_t>();
+	}
+
+	vector<RedisAttachedTable> tables;
+	try {
+		RedisClient client;
+		if (!client.Connect(endpoint)) {
+			throw IOException("redis attach: could not connect to Redis at %s: %s", endpoint.ToString(),
+			                  client.LastError());
+		}
+		tables = DiscoverTables(client, prefixes, sample_keys);
+	} catch (Exception &) {
+		// already says "redis attach:"
+		throw;
+	} catch (std::runtime_error &ex) {
+		throw IOException("redis attach: %s", ex.what());
+	}
+
+	// the catalog itself only holds views, in memory
+	info.path = ":memory:";
+	return make_uniq<RedisCatalog>(db, endpoint, std::move(tables));
+}
+
+static unique_ptr<TransactionManager> RedisCreateTransactionManager(optional_ptr<StorageExtensionInfo>,
+                                                                   AttachedDatabase &db, Catalog &) {
+	return make_uniq<DuckTransactionManager>(db);
+}
+
+class RedisStorageExtension : public StorageExtension {
+public:
+	RedisStorageExtension() {
+		attach = RedisAttach;
+		create_transaction_manager = RedisCreateTransactionManager;
+	}
+};
+
+/*
+  CREATE SECRET (TYPE redis, HOST 'h', PORT 6379, DB 0, TLS true, USERNAME 'u', PASSWORD 'p' [, SCOPE 'redis://h'])
+    - Used by ATTACH ... (TYPE redis); without a SCOPE it applies to every redis://, rediss:// and unix:// path.
+*/
+static unique_ptr<BaseSecret> CreateRedisSecret(ClientContext &, CreateSecretInput &input) {
+	auto scope = input.scope;
+	if (scope.empty()) {
+		scope = {"redis://", "rediss://", "unix://"};
+	}
+	auto secret = make_uniq<KeyValueSecret>(scope, input.type, input.provider, input.name);
+	for (auto &option : input.options) {
+		auto key = StringUtil::Lower(option.first);
+		if (key != "host" && key != "port" && key != "db" && key != "tls" && key != "username" && key != "password") {
+			throw InvalidInputException("Unknown parameter for a redis secret: %s", option.first);
+		}
+		secret->secret_map[key] = option.second;
+	}
+	secret->redact_keys = {"password"};
+	return std::move(secret);
+}
+
+// -------------------------------------------------------------------------------------------------
+//  SETUP
+// -------------------------------------------------------------------------------------------------
+static void LoadInternal(ExtensionLoader &loader) {
+	// Register a scalar function
+	auto redduck_scalar_function = ScalarFunction("redduck", {LogicalType::VARCHAR}, LogicalType::VARCHAR, RedduckScalarFun);
 	auto set_name_scalar_function = ScalarFunction("set_name", {LogicalType::VARCHAR}, LogicalType::VARCHAR, SetNameScalarFun);
 	auto set_address_scalar_function = ScalarFunction("redis_connect", {LogicalType::VARCHAR}, LogicalType::VARCHAR, SetAddressScalarFun);
-	auto get_key_scalar_function = ScalarFunction("redis_get", {LogicalType::VARCHAR}, LogicalType::VARCHAR, GetKeyScalarFun);
+	ScalarFunctionSet get_key_scalar_function("redis_get");
+	get_key_scalar_function.AddFunction(ScalarFunction({LogicalType::VARCHAR}, LogicalType::VARCHAR, GetKeyScalarFun, RedisGetBind));
+	// redis_get(key, 'bigint' | 'double' | 'json' | ...): the return type is set in RedisGetBind.
+	get_key_scalar_function.AddFunction(ScalarFunction({LogicalType::VARCHAR, LogicalType::VARCHAR}, LogicalType::VARCHAR, GetKeyScalarFun, RedisGetBind));
+	// Same lookup, but the bytes are returned untouched as BLOB (binary values are not valid VARCHAR).
+	auto get_blob_scalar_function = ScalarFunction("redis_get_blob", {LogicalType::VARCHAR}, LogicalType::BLOB, GetKeyScalarFun, RedisGetBind);
 	// Register table functions
 	TableFunction scan_func("redis_scan", {LogicalType::VARCHAR}, RedisScanFunc, RedisScanBind, RedisScanInit);
+	TableFunction kv_func("redis_kv", {LogicalType::VARCHAR}, RedisScanFunc, RedisKvBind, RedisScanInit);
+	kv_func.named_parameters["value_type"] = LogicalType::VARCHAR;
+	kv_func.named_parameters["compression"] = LogicalType::VARCHAR;
+	// Hashes as rows: one column per listed field.
+	TableFunction hash_scan_func("redis_hash_scan", {LogicalType::VARCHAR, LogicalType::LIST(LogicalType::VARCHAR)},
+	                             RedisScanFunc, RedisHashScanBind, RedisScanInit);
+	hash_scan_func.projection_pushdown = true;
+	hash_scan_func.to_string = RedisScanToString;
+	for (auto function : {&scan_func, &kv_func, &hash_scan_func}) {
+		function->named_parameters["endpoint"] = LogicalType::VARCHAR;
+		function->named_parameters["attached"] = LogicalType::VARCHAR;
+		function->named_parameters["estimated_keys"] = LogicalType::BIGINT;
+		function->cardinality = RedisScanCardinality;
+	}
+	// key_name/value and the metadata columns are only read when projected
+	scan_func.projection_pushdown = true;
+	kv_func.projection_pushdown = true;
+	scan_func.get_virtual_columns = RedisScanVirtualColumns;
+	scan_func.to_string = RedisScanToString;
+	scan_func.dynamic_to_string = RedisScanDynamicToString;
+	kv_func.to_string = RedisScanToString;
+	kv_func.dynamic_to_string = RedisScanDynamicToString;
+	// Lists as rows: (key_name, idx, value), read in pipelined LRANGE windows.
+	TableFunctionSet lrange_set("redis_lrange");
+	for (auto &arguments : {vector<LogicalType> {LogicalType::VARCHAR},
+	                        vector<LogicalType> {LogicalType::VARCHAR, LogicalType::BIGINT, LogicalType::BIGINT}}) {
+		TableFunction lrange_func(arguments, RedisLrangeFunc, RedisLrangeBind, RedisLrangeInit);
+		lrange_func.named_parameters["endpoint"] = LogicalType::VARCHAR;
+		lrange_func.named_parameters["attached"] = LogicalType::VARCHAR;
+		lrange_func.named_parameters["estimated_keys"] = LogicalType::BIGINT;
+		lrange_func.to_string = RedisLrangeToString;
+		lrange_set.AddFunction(lrange_func);
+	}
+	// Bitmaps: set bits as (key_name, offset) rows, BITCOUNT and BITOP AND / OR evaluated locally.
+	TableFunction bitmap_func("redis_bitmap", {LogicalType::VARCHAR}, RedisBitmapFunc, RedisBitmapBind, RedisBitmapInit);
+	bitmap_func.named_parameters["endpoint"] = LogicalType::VARCHAR;
+	bitmap_func.named_parameters["attached"] = LogicalType::VARCHAR;
+	bitmap_func.named_parameters["estimated_keys"] = LogicalType::BIGINT;
+	auto bitmap_count_function =
+	    ScalarFunction("redis_bitmap_count", {LogicalType::BLOB}, LogicalType::BIGINT, BitmapCountScalarFun);
+	// Snapshot a keyspace into a table and keep it in sync from keyspace notifications.
+	TableFunction materialize_func("redis_materialize", {LogicalType::VARCHAR, LogicalType::VARCHAR},
+	                               RedisMaterializeFunc, RedisMaterializeBind, RedisMaterializeInit);
+	auto materialize_stop_function = ScalarFunction("redis_materialize_stop", {LogicalType::VARCHAR},
+	                                                LogicalType::BOOLEAN, StopMaterializeScalarFun);
+	materialize_stop_function.stability = FunctionStability::VOLATILE;
+	TableFunction workers_func("redis_workers", {}, RedisWorkersFunc, RedisWorkersBind, RedisWorkersInit);
+	// Pub/Sub messages as rows, or appended to a table in the background.
+	TableFunctionSet subscribe_set("redis_subscribe");
+	TableFunctionSet subscribe_into_set("redis_subscribe_into");
+	for (auto &channels : {LogicalType::VARCHAR, LogicalType::LIST(LogicalType::VARCHAR)}) {
+		TableFunction subscribe_func({channels}, RedisSubscribeFunc, RedisSubscribeBind, RedisSubscribeInit);
+		subscribe_func.named_parameters["max_messages"] = LogicalType::BIGINT;
+		subscribe_func.named_parameters["max_duration"] = LogicalType::INTERVAL;
+		subscribe_set.AddFunction(subscribe_func);
+		subscribe_into_set.AddFunction(TableFunction({channels, LogicalType::VARCHAR}, RedisSubscribeIntoFunc,
+		                                             RedisSubscribeIntoBind, RedisSubscribeIntoInit));
+	}
+	auto subscribe_stop_function =
+	    ScalarFunction("redis_subscribe_stop", {LogicalType::VARCHAR}, LogicalType::BOOLEAN, StopSubscribeScalarFun);
+	subscribe_stop_function.stability = FunctionStability::VOLATILE;
+	ScalarFunctionSet publish_function("redis_publish");
+	for (auto &message : {LogicalType::VARCHAR, LogicalType::BLOB}) {
+		ScalarFunction publish({LogicalType::VARCHAR, message}, LogicalType::BIGINT, PublishScalarFun);
+		publish.stability = FunctionStability::VOLATILE;
+		publish_function.AddFunction(publish);
+	}
+	TableFunction memory_func("redis_memory", {}, RedisMemoryFunc, RedisMemoryBind, RedisMemoryInit);
 
 	loader.RegisterFunction(redduck_scalar_function);
 	loader.RegisterFunction(set_name_scalar_function);
 	loader.RegisterFunction(set_address_scalar_function);
 	loader.RegisterFunction(get_key_scalar_function);
+	loader.RegisterFunction(get_blob_scalar_function);
+
 	loader.RegisterFunction(scan_func);
+	loader.RegisterFunction(kv_func);
+	loader.RegisterFunction(hash_scan_func);
+	loader.RegisterFunction(lrange_set);
+	loader.RegisterFunction(bitmap_func);
+	loader.RegisterFunction(bitmap_count_function);
+	loader.RegisterFunction(BitmapCombineAggregate<true>("redis_bitmap_and"));
+	loader.RegisterFunction(BitmapCombineAggregate<false>("redis_bitmap_or"));
+	loader.RegisterFunction(materialize_func);
+	loader.RegisterFunction(materialize_stop_function);
+	loader.RegisterFunction(workers_func);
+	loader.RegisterFunction(subscribe_set);
+	loader.RegisterFunction(subscribe_into_set);
+	loader.RegisterFunction(subscribe_stop_function);
+	loader.RegisterFunction(publish_function);
+	loader.RegisterFunction(memory_func);
+
+	SecretType secret_type;
+	secret_type.name = "redis";
+	secret_type.deserializer = KeyValueSecret::Deserialize<KeyValueSecret>;
+	secret_type.default_provider = "config";
+	loader.RegisterSecretType(secret_type);
+	CreateSecretFunction secret_function = {"redis", "config", CreateRedisSecret};
+	secret_function.named_parameters["host"] = LogicalType::VARCHAR;
+	secret_function.named_parameters["port"] = LogicalType::INTEGER;
+	secret_function.named_parameters["db"] = LogicalType::INTEGER;
+	secret_function.named_parameters["tls"] = LogicalType::BOOLEAN;
+	secret_function.named_parameters["username"] = LogicalType::VARCHAR;
+	secret_function.named_parameters["password"] = LogicalType::VARCHAR;
+	loader.RegisterFunction(secret_function);
+
+	// Receive segments and parser tapes count against a database's memory limit.
+	InstallTransportAllocator(loader.GetDatabaseInstance());
+
+	// Settings
+	auto &config = DBConfig::GetConfig(loader.GetDatabaseInstance());
+	config.storage_extensions["redis"] = make_uniq<RedisStorageExtension>();
+	config.AddExtensionOption("redis_large_value_threshold",
+	                          "Values of at least this many bytes are received directly into DuckDB string storage "
+	                          "instead of the pooled receive buffers (0 disables)",
+	                          LogicalType::UBIGINT, Value::UBIGINT(DEFAULT_LARGE_VALUE_THRESHOLD));
+	config.AddExtensionOption("redis_malformed_values_as_null",
+	                          "Values that are not valid for the type requested from redis_get/redis_kv (BIGINT, "
+	                          "DOUBLE, JSON) become NULL instead of raising an error",
+	                          LogicalType::BOOLEAN, Value::BOOLEAN(false));
+	config.AddExtensionOption("redis_compression",
+	                          "Decompress LZ4/zstd framed values returned by redis_get/redis_kv: none, auto, lz4 or zstd "
+	                          "(values without a frame header are returned as stored)",
+	                          LogicalType::VARCHAR, Value("none"));
+	config.AddExtensionOption("redis_aggregate_pushdown",
+	                          "Evaluate COUNT/SUM/MIN/MAX over redis_scan and redis_kv inside Redis with a Lua script",
+	                          LogicalType::BOOLEAN, Value::BOOLEAN(true));
+	config.AddExtensionOption("redis_pushdown_pages_per_call",
+	                          "SCAN pages a pushed down aggregate script may walk per call before yielding the server",
+	                          LogicalType::UBIGINT, Value::UBIGINT(10));
+	config.AddExtensionOption("redis_replicas",
+	                          "Comma separated HOST:PORT list of replicas to read from, 'auto' to ask the primary "
+	                          "(ROLE), or '' to read from the primary only",
+	                          LogicalType::VARCHAR, Value(""));
+	config.AddExtensionOption("redis_max_replica_lag_bytes",
+	                          "Replicas whose replication offset is more bytes behind the primary's are not read "
+	                          "from (-1 disables the check)",
+	                          LogicalType::BIGINT, Value::BIGINT(DEFAULT_MAX_REPLICA_LAG_BYTES));
+	config.AddExtensionOption("redis_request_timeout_ms",
+	                          "Milliseconds a request may go without receiving reply bytes before the connection is "
+	                          "dropped and the read retried (0 waits for as long as the socket allows)",
+	                          LogicalType::BIGINT, Value::BIGINT(5000));
+	config.AddExtensionOption("redis_read_retries",
+	                          "Times a failed or timed out read (GET pipeline, SCAN page) is sent again",
+	                          LogicalType::BIGINT, Value::BIGINT(2));
+	config.AddExtensionOption("redis_hedge_reads",
+	                          "Send a GET pipeline to a second replica or connection once it has been pending for "
+	                          "longer than the p95 round trip of its server; the first answer wins",
+	                          LogicalType::BOOLEAN, Value::BOOLEAN(false));
+
+	// Optimizer
+	OptimizerExtension aggregate_pushdown;
+	aggregate_pushdown.optimize_function = RedisAggregatePushdown;
+	config.optimizer_extensions.push_back(std::move(aggregate_pushdown));
+	// Registered after the aggregate pushdown, which must not see a sampled scan as a full one.
+	OptimizerExtension sample_pushdown;
+	sample_pushdown.optimize_function = RedisSamplePushdown;
+	config.optimizer_extensions.push_back(std::move(sample_pushdown));
+	OptimizerExtension lrange_pushdown;
+	lrange_pushdown.optimize_function = RedisLrangePushdown;
+	config.optimizer_extensions.push_back(std::move(lrange_pushdown));
 }
 
 void RedduckExtension::Load(ExtensionLoader &loader) {
@@ -0,0 +1,168 @@
+/*
+  bitmap_decoder.cpp
+*/
+
+#include "transport/bitmap_decoder.hpp"
+#include <bit>
+#include <cstring>
+
+#if defined(__x86_64__) && (defined(__GNUC__) || defined(__clang__))
+#define BITMAP_DISPATCH 1
+#define BITMAP_INLINE inline __attribute__((always_inline))
+#else
+#define BITMAP_INLINE inline
+#endif
+
+namespace {
+
+// Reverses the bits of every byte, so bit n of a little endian word is bit n of the bitmap.
+BITMAP_INLINE uint64_t ReverseBitsInBytes(uint64_t word) {
+    word = ((word >> 1) & 0x5555555555555555ULL) | ((word & 0x5555555555555555ULL) << 1);
+    word = ((word >> 2) & 0x3333333333333333ULL) | ((word & 0x3333333333333333ULL) << 2);
+    return ((word >> 4) & 0x0F0F0F0F0F0F0F0FULL) | ((word & 0x0F0F0F0F0F0F0F0FULL) << 4);
+}
+
+BITMAP_INLINE uint64_t LoadWord(const char* data) {
+    uint64_t word;
+    std::memcpy(&word, data, sizeof(word));
+    if constexpr (std::endian::native == std::endian::big) {
+        uint64_t swapped = 0;
+        for (int i = 0; i < 8; i++) {
+            swapped = (swapped << 8) | ((word >> (8 * i)) & 0xFF);
+        }
+        word = swapped;
+    }
+    return word;
+}
+
+/*
+  Set bits of one word, lowest first. Offsets are written 8 at a time without
+  checking how many bits are left (countr_zero of an exhausted word is 64), so
+  the loop has no unpredictable branch for sparse and dense words alike; the
+  extra entries are overwritten by the next word.
+*/
+BITMAP_INLINE size_t ExtractWord(uint64_t word, int64_t base, int64_t* out) {
+    size_t bits = static_cast<size_t>(std::popcount(word));
+    for (size_t i = 0; i < bits; i += 8) {
+        for (size_t j = 0; j < 8; j++) {
+            out[i + j] = base + std::countr_zero(word);
+            word &= word - 1;
+        }
+    }
+    return bits;
+}
+
+BITMAP_INLINE size_t DecodeKernel(const char* data, size_t len, int64_t first_bit, int64_t* out, size_t capacity,
+                                  size_t& consumed) {
+    size_t count = 0;
+    size_t pos = 0;
+    while (pos < len && count + BITMAP_DECODE_SLACK <= capacity) {
+        // skip runs of zero bytes 32 at a time; sparse bitmaps are mostly zeros
+        if (len - pos >= 32) {
+            uint64_t any = LoadWord(data + pos) | LoadWord(data + pos + 8) | LoadWord(data + pos + 16) |
+                           LoadWord(data + pos + 24);
+            if (any == 0) {
+                pos += 32;
+                continue;
+            }
+        }
+        uint64_t word;
+        size_t width = len - pos < 8 ? len - pos : 8;
+        if (width == 8) {
+            word = LoadWord(data + pos);
+        } else {
+            char tail[8] = {};
+            std::memcpy(tail, data + pos, width);
+            word = LoadWord(tail);
+        }
+        if (word != 0) {
+            count += ExtractWord(ReverseBitsInBytes(word), first_bit + static_cast<int64_t>(pos) * 8, out + count);
+        }
+        pos += width;
+    }
+    consumed = pos;
+    return count;
+}
+
+BITMAP_INLINE uint64_t CountKernel(const char* data, size_t len) {
+    uint64_t count = 0;
+    size_t pos = 0;
+    for (; pos + 8 <= len; pos += 8) {
+        count += static_cast<uint64_t>(std::popcount(LoadWord(data + pos)));
+    }
+    for (; pos < len; pos++) {
+        count += static_cast<uint64_t>(std::popcount(static_cast<unsigned char>(data[pos])));
+    }
+    return count;
+}
+
+// Byte loops on purpose: the compiler turns them into full width vector code.
+BITMAP_INLINE void AndKernel(char* acc, const char* other, size_t len) {
+    for (size_t i = 0; i < len; i++) {
+        acc[i] = static_cast<char>(acc[i] & other[i]);
+    }
+}
+
+BITMAP_INLINE void OrKernel(char* acc, const char* other, size_t len) {
+    for (size_t i = 0; i < len; i++) {
+        acc[i] = static_cast<char>(acc[i] | other[i]);
+    }
+}
+
+#ifdef BITMAP_DISPATCH
+// The same kernels compiled for AVX2 (and BMI/POPCNT for the bit scans); HasAvx2() checks every one of them.
+#define BITMAP_AVX2 __attribute__((target("avx2,bmi,bmi2,popcnt")))
+
+BITMAP_AVX2 size_t DecodeAvx2(const char* data, size_t len, int64_t first_bit, int64_t* out, size_t capacity,
+                              size_t& consumed) {
+    return DecodeKernel(data, len, first_bit, out, capacity, consumed);
+}
+BITMAP_AVX2 uint64_t CountAvx2(const char* data, size_t len) { return CountKernel(data, len); }
+BITMAP_AVX2 void AndAvx2(char* acc, const char* other, size_t len) { AndKernel(acc, other, len); }
+BITMAP_AVX2 void OrAvx2(char* acc, const char* other, size_t len) { OrKernel(acc, other, len); }
+
+bool HasAvx2() {
+    static const bool supported = __builtin_cpu_supports("avx2") && __builtin_cpu_supports("bmi") &&
+                                  __builtin_cpu_supports("bmi2") && __builtin_cpu_supports("popcnt");
+    return supported;
+}
+#endif
+
+} // namespace
+
+size_t DecodeSetBits(const char* data, size_t len, int64_t first_bit, int64_t* out, size_t capacity,
+                     size_t& consumed) {
+#ifdef BITMAP_DISPATCH
+    if (HasAvx2()) {
+        return DecodeAvx2(data, len, first_bit, out, capacity, consumed);
+    }
+#endif
+    return DecodeKernel(data, len, first_bit, out, capacity, consumed);
+}
+
+uint64_t CountSetBits(const char* data, size_t len) {
+#ifdef BITMAP_DISPATCH
+    if (HasAvx2()) {
+        return CountAvx2(data, len);
+    }
+#endif
+    return CountKernel(data, len);
+}
+
+void AndBitmaps(char* acc, const char* other, size_t len) {
+#ifdef BITMAP_DISPATCH
+    if (HasAvx2()) {
+        return AndAvx2(acc, other, len);
+    }
+#endif
+    AndKernel(acc, other, len);
+}
+
+void OrBitmaps(char* acc, const char* other, size_t len) {
+#ifdef BITMAP_DISPATCH
+    if (HasAvx2()) {
+        return OrAvx2(acc, other, len);
+    }
+#endif
+    OrKernel(acc, other, len);
+}
@@ -0,0 +1,41 @@
+/*
+  connection_pool.cpp
+*/
+
+#include "transport/connection_pool.hpp"
+#include <stdexcept>
+
+ConnectionPool::ConnectionPool(RedisEndpoint endpoint_p) : endpoint(std::move(endpoint_p)) {}
+
+std::unique_ptr<RedisClient> ConnectionPool::Acquire() {
+    {
+        std::lock_guard<std::mutex> guard(lock);
+        while (!idle.empty()) {
+            std::unique_ptr<RedisClient> client = std::move(idle.back());
+            idle.pop_back();
+            if (client->IsConnected()) {
+                return client;
+            }
+        }
+    }
+
+    auto client = std::make_unique<RedisClient>();
+    if (!client->Connect(endpoint)) {
+        throw std::runtime_error("ERROR: could not connect to Redis at " + endpoint.ToString() + ": " +
+                                 client->LastError());
+    }
+    return client;
+}
+
+void ConnectionPool::Release(std::unique_ptr<RedisClient> client) {
+    // replies still in flight would be read by the next borrower
+    if (!client->IsConnected() || client->Outstanding() != 0) {
+        return;
+    }
+    client->ClearBuffer();
+
+    std::lock_guard<std::mutex> guard(lock);
+    if (idle.size() < max_idle) {
+        idle.push_back(std::move(client));
+    }
+}
@@ -0,0 +1,64 @@
+/*
+  keyspace_listener.cpp
+*/
+
+#include "transport/keyspace_listener.hpp"
+#include <stdexcept>
+
+// A notification only names the key; these flag sets make sure writes, deletes and expiries are all published.
+static bool PublishesKeyChanges(std::string_view flags) {
+    if (flags.find('K') == std::string_view::npos) {
+        return false;
+    }
+    if (flags.find('A') != std::string_view::npos) {
+        return true;
+    }
+    return flags.find('$') != std::string_view::npos && flags.find('g') != std::string_view::npos &&
+           flags.find('x') != std::string_view::npos;
+}
+
+KeyspaceListener::KeyspaceListener(const RedisEndpoint& endpoint, int db, const std::string& pattern) {
+    if (!client.Connect(endpoint)) {
+        throw std::runtime_error("cannot connect to " + endpoint.ToString() + ": " + client.LastError());
+    }
+
+    // Managed servers may refuse CONFIG; then the events are simply assumed to be on.
+    const RespObject& config = client.RunCommand({"CONFIG", "GET", "notify-keyspace-events"}, parser);
+    if (config.type == RespType::ARRAY && config.children.size() == 2 &&
+        !PublishesKeyChanges(config.children[1].AsString())) {
+        throw std::runtime_error("keyspace notifications are disabled on " + endpoint.ToString() +
+                                 " (CONFIG SET notify-keyspace-events KA)");
+    }
+    parser.ClearObjects();
+    client.ClearBuffer();
+
+    channel_prefix = "__keyspace@" + std::to_string(db) + "__:";
+    std::string channel = channel_prefix + pattern;
+    const RespObject& reply = client.RunCommand({"PSUBSCRIBE", channel}, parser);
+    if (reply.type != RespType::ARRAY || reply.children.empty() || reply.children[0].AsString() != "psubscribe") {
+        throw std::runtime_error("PSUBSCRIBE " + channel + " failed");
+    }
+    // notifications may already follow the confirmation in the same segment
+    parser.ClearObjects();
+    client.ReleaseParsed();
+}
+
+size_t KeyspaceListener::Poll(std::unordered_set<std::string>& changed, int timeout_ms) {
+    size_t count = client.ReadPushed(parser, timeout_ms);
+
+    // ["pmessage", pattern, "__keyspace@<db>__:<key>", event]
+    for (const auto& message : parser.Objects()) {
+        if (message.type != RespType::ARRAY || message.children.size() != 4 ||
+            message.children[0].AsString() != "pmessage") {
+            continue;
+        }
+        std::string_view channel = message.children[2].AsString();
+        if (channel.substr(0, channel_prefix.size()) != channel_prefix) {
+            continue;
+        }
+        changed.emplace(channel.substr(channel_prefix.size()));
+    }
+    parser.ClearObjects();
+    client.ReleaseParsed();
+    return count;
+}
@@ -0,0 +1,91 @@
+/*
+  pubsub_subscriber.cpp
+*/
+
+#include "transport/pubsub_subscriber.hpp"
+#include <stdexcept>
+
+// Confirmations look like ["subscribe", channel, count] and ["psubscribe", pattern, count].
+static bool IsConfirmation(const RespObject& frame) {
+    if ((frame.type != RespType::ARRAY && frame.type != RespType::PUSH) || frame.children.empty()) {
+        return false;
+    }
+    std::string_view kind = frame.children[0].AsString();
+    return kind == "subscribe" || kind == "psubscribe";
+}
+
+bool PubSubSubscriber::IsPattern(std::string_view name) {
+    return name.find_first_of("*?[") != std::string_view::npos;
+}
+
+PubSubSubscriber::PubSubSubscriber(const RedisEndpoint& endpoint, const std::vector<std::string>& channels) {
+    if (channels.empty()) {
+        throw std::runtime_error("no channels to subscribe to");
+    }
+    if (!client.Connect(endpoint)) {
+        throw std::runtime_error("cannot connect to " + endpoint.ToString() + ": " + client.LastError());
+    }
+
+    std::vector<std::string_view> subscribe{"SUBSCRIBE"};
+    std::vector<std::string_view> psubscribe{"PSUBSCRIBE"};
+    for (const auto& channel : channels) {
+        (IsPattern(channel) ? psubscribe : subscribe).push_back(channel);
+    }
+    RespEncoder encoder;
+    if (subscribe.size() > 1) {
+        encoder.AppendCommand(subscribe);
+    }
+    if (psubscribe.size() > 1) {
+        encoder.AppendCommand(psubscribe);
+    }
+    if (!client.SendEncoded(encoder)) {
+        throw std::runtime_error("could not send SUBSCRIBE to " + endpoint.ToString());
+    }
+
+    // One confirmation per name; messages of the channels confirmed first may already be interleaved.
+    size_t confirmed = 0;
+    size_t checked = 0;
+    auto deadline = std::chrono::steady_clock::now() + std::chrono::milliseconds(client.request_timeout_ms);
+    while (confirmed < channels.size()) {
+        if (client.ReadPushed(parser, 100) == 0 && std::chrono::steady_clock::now() > deadline) {
+            throw std::runtime_error("timed out waiting for the subscriptions on " + endpoint.ToString());
+        }
+        for (; checked < parser.ObjectCount(); checked++) {
+            const RespObject& frame = parser.Objects()[checked];
+            if (frame.type == RespType::ERROR) {
+                throw std::runtime_error("SUBSCRIBE failed: " + std::string(frame.AsString()));
+            }
+            confirmed += IsConfirmation(frame);
+        }
+    }
+}
+
+size_t PubSubSubscriber::Poll(std::vector<PubSubMessage>& messages, int timeout_ms) {
+    // messages left over from the subscription handshake are returned without waiting
+    client.ReadPushed(parser, consumed < parser.ObjectCount() ? 0 : timeout_ms);
+    auto received = std::chrono::system_clock::now();
+
+    size_t before = messages.size();
+    const RespTape& frames = parser.Objects();
+    for (; consumed < frames.size(); consumed++) {
+        const RespObject& frame = frames[consumed];
+        if ((frame.type != RespType::ARRAY && frame.type != RespType::PUSH) || frame.children.size() < 3) {
+            continue;
+        }
+        const auto& parts = frame.children;
+        std::string_view kind = parts[0].AsString();
+        // ["message", channel, payload] and ["pmessage", pattern, channel, payload]
+        if (kind == "message" && parts.size() == 3) {
+            messages.push_back({parts[1].AsString(), {}, parts[2].AsString(), received});
+        } else if (kind == "pmessage" && parts.size() == 4) {
+            messages.push_back({parts[2].AsString(), parts[1].AsString(), parts[3].AsString(), received});
+        }
+    }
+    return messages.size() - before;
+}
+
+void PubSubSubscriber::Release() {
+    parser.ClearObjects();
+    client.ReleaseParsed();
+    consumed = 0;
+}
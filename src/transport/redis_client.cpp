@@ -8,93 +8,240 @@
 #include <stdexcept>
 #include <cstring>
 #include <charconv>
+#include <algorithm>
+
+#ifndef _WIN32
+#include <sys/uio.h>
+#endif
+
+#include <openssl/err.h>
+#include <openssl/evp.h>
+
+// Receive at least this many bytes per recv() before a new segment is started.
+constexpr size_t MIN_RECV_SPACE = 4096;
+// Upper bound of iovecs handed to one sendmsg() call (POSIX IOV_MAX is >= 1024).
+constexpr size_t MAX_SEND_SLICES = 1024;
+// Largest TLS record payload. Pipelines are cut into records of this size instead of one record per command.
+constexpr size_t TLS_RECORD_SIZE = 16 * 1024;
+
+// OpenSSL's reason for a failed SSL_connect(), plus the certificate check's when that is what failed.
+static std::string TlsErrorString(SSL* ssl, int result) {
+    std::string message;
+    unsigned long code = ERR_get_error();
+    if (code != 0) {
+        char buffer[256];
+        ERR_error_string_n(code, buffer, sizeof(buffer));
+        message = buffer;
+    } else {
+        switch (SSL_get_error(ssl, result)) {
+        case SSL_ERROR_WANT_READ:
+        case SSL_ERROR_WANT_WRITE:
+            // the socket timeout expired: often a server that does not speak TLS on this port
+            message = "timed out";
+            break;
+        case SSL_ERROR_SYSCALL:
+        case SSL_ERROR_ZERO_RETURN:
+            message = "connection closed by the server";
+            break;
+        default:
+            message = "unknown error";
+        }
+    }
+    long verify = SSL_get_verify_result(ssl);
+    if (verify != X509_V_OK) {
+        message += std::string(" (") + X509_verify_cert_error_string(verify) + ")";
+    }
+    return message;
+}
 
 RedisClient::RedisClient() {
     sock_fd = INVALID_SOCKET;
     is_connected = false;
-    buffer_capacity = BUFFER_SIZE;
-    current_offset = 0;
+    outstanding = 0;
+    parsed_offset = 0;
+    ssl = nullptr;
+    ktls_send = false;
 
     if (!init_sockets()) {
         throw std::runtime_error("Failed to initialize socket library.");
     }
-
-    try {
-        buffer = new char[BUFFER_SIZE];
-    } catch (...) {
-        cleanup_sockets();
-        throw std::runtime_error("Not able to allocate Memory");
-    }
 }
 
 RedisClient::~RedisClient() {
+    FreeTls();
     if (sock_fd != INVALID_SOCKET) {
         CLOSE_SOCKET(sock_fd);
     }
-    delete[] buffer;
+    chain.Clear();
     cleanup_sockets();
 }
 
-void RedisClient::EnsureBufferSize(size_t needed_size) {
-    if (needed_size + current_offset < buffer_capacity) {
-        return;
+void RedisClient::FreeTls() {
+    if (ssl) {
+        // Closing without a close_notify would make OpenSSL drop the session from resumption.
+        SSL_set_shutdown(ssl, SSL_SENT_SHUTDOWN | SSL_RECEIVED_SHUTDOWN);
+        SSL_free(ssl);
+        ssl = nullptr;
     }
+    ktls_send = false;
+}
 
-    size_t new_capacity =
-        std::max(buffer_capacity * 2, current_offset + needed_size);
-
-    char* new_buffer = new char[new_capacity];
-    std::memcpy(new_buffer, buffer, current_offset);
-    delete[] buffer;
-
-    buffer = new_buffer;
-    buffer_capacity = new_capacity;
+void RedisClient::Disconnect() {
+    FreeTls();
+    if (sock_fd != INVALID_SOCKET) {
+        CLOSE_SOCKET(sock_fd);
+        sock_fd = INVALID_SOCKET;
+    }
+    is_connected = false;
+    outstanding = 0;
+    ClearBuffer();
 }
 
 void RedisClient::ClearBuffer(){
-  current_offset = 0;
+  chain.Clear();
+  parsed_offset = 0;
+}
+
+bool RedisClient::Connect(const RedisEndpoint& endpoint) {
+    host = endpoint.host;
+    port = endpoint.port;
+    tls = endpoint.tls;
+    unix_path = endpoint.unix_path;
+    db = endpoint.db;
+    username = endpoint.username;
+    password = endpoint.password;
+    return Open();
 }
 
 bool RedisClient::Connect(const char* host, int port) {
-    if (sock_fd != INVALID_SOCKET) {
-        CLOSE_SOCKET(sock_fd);
-        sock_fd = INVALID_SOCKET;
+    RedisEndpoint endpoint;
+    endpoint.host = host;
+    endpoint.port = port;
+    endpoint.tls = tls;
+    endpoint.db = db;
+    endpoint.username = username;
+    endpoint.password = password;
+    return Connect(endpoint);
+}
+
+bool RedisClient::OpenSocket() {
+    if (!unix_path.empty()) {
+#ifdef _WIN32
+        last_error = "Unix domain sockets are not supported on this platform";
+        return false;
+#else
+        sockaddr_un server_addr{};
+        if (unix_path.size() >= sizeof(server_addr.sun_path)) {
+            last_error = "Unix socket path too long: " + unix_path;
+            return false;
+        }
+        server_addr.sun_family = AF_UNIX;
+        std::memcpy(server_addr.sun_path, unix_path.c_str(), unix_path.size() + 1);
+
+        sock_fd = socket(AF_UNIX, SOCK_STREAM, 0);
+        if (sock_fd == INVALID_SOCKET) {
+            last_error = "socket() failed, error " + std::to_string(GET_SOCKET_ERROR());
+            return false;
+        }
+        set_socket_timeout(sock_fd, connection_timeout);
+        if (connect(sock_fd, (struct sockaddr*)&server_addr, sizeof(server_addr)) < 0) {
+            last_error = "connection to " + unix_path + " failed, error " + std::to_string(GET_SOCKET_ERROR());
+            CLOSE_SOCKET(sock_fd);
+            sock_fd = INVALID_SOCKET;
+            return false;
+        }
+        set_low_latency(sock_fd, false);
+        return true;
+#endif
     }
-    is_connected = false;
 
-    // Create socket
-    sock_fd = socket(AF_INET, SOCK_STREAM, 0);
-    if (sock_fd == INVALID_SOCKET) {
-        std::cerr << "ERROR: socket() failed error: " << GET_SOCKET_ERROR() << "\n";
+    // Names, IPv4 and IPv6 addresses; every address is tried in the resolver's order.
+    addrinfo hints{};
+    hints.ai_family = AF_UNSPEC;
+    hints.ai_socktype = SOCK_STREAM;
+    hints.ai_flags = AI_NUMERICSERV;
+    addrinfo* addresses = nullptr;
+    std::string service = std::to_string(port);
+    int resolved = getaddrinfo(host.c_str(), service.c_str(), &hints, &addresses);
+    if (resolved != 0) {
+        last_error = "could not resolve " + host + ": " + gai_strerror(resolved);
         return false;
     }
 
-    // Address structure
-    sockaddr_in server_addr{};
-    server_addr.sin_family = AF_INET;
-    server_addr.sin_port = htons(port);
+    for (addrinfo* address = addresses; address; address = address->ai_next) {
+        sock_fd = socket(address->ai_family, address->ai_socktype, address->ai_protocol);
+        if (sock_fd == INVALID_SOCKET) {
+            continue;
+        }
+        set_socket_timeout(sock_fd, connection_timeout);
+        if (connect(sock_fd, address->ai_addr, static_cast<socklen_t>(address->ai_addrlen)) == 0) {
+            break;
+        }
+        CLOSE_SOCKET(sock_fd);
+        sock_fd = INVALID_SOCKET;
+    }
+    freeaddrinfo(addresses);
 
-    if (inet_pton(AF_INET, host, &server_addr.sin_addr) <= 0) {
+    if (sock_fd == INVALID_SOCKET) {
+        last_error = "connection failed, error " + std::to_string(GET_SOCKET_ERROR());
         return false;
     }
+    set_low_latency(sock_fd, true);
+    return true;
+}
 
-    // connect
-    set_socket_timeout(sock_fd, connection_timeout);
-    int conn_result =
-        connect(sock_fd,
-                (struct sockaddr*)&server_addr,
-                sizeof(server_addr));
-
-    if (conn_result < 0) {
-        std::cerr << "ERROR: Connection failed error: "
-                  << GET_SOCKET_ERROR() << "\n";
+bool RedisClient::Open() {
+    FreeTls();
+    if (sock_fd != INVALID_SOCKET) {
         CLOSE_SOCKET(sock_fd);
         sock_fd = INVALID_SOCKET;
+    }
+    is_connected = false;
+    outstanding = 0;
+    ClearBuffer();
+    last_error.clear();
+
+    if (!OpenSocket()) {
         return false;
     }
 
+    if (tls) {
+        session_key = host + ":" + std::to_string(port);
+        ssl = TlsContext::Instance().NewConnection(static_cast<int>(sock_fd), host, session_key);
+        // errors left over from another connection on this thread would be reported as ours
+        ERR_clear_error();
+        int handshake = SSL_connect(ssl);
+        if (handshake != 1) {
+            last_error = "TLS handshake with " + session_key + " failed: " + TlsErrorString(ssl, handshake);
+            Disconnect();
+            return false;
+        }
+#ifdef BIO_get_ktls_send
+        ktls_send = BIO_get_ktls_send(SSL_get_wbio(ssl)) != 0;
+#endif
+    }
+
     is_connected = true;
 
+    if (!password.empty()) {
+        RespParser auth_parser;
+        try {
+            const RespObject& reply = username.empty() ? RunCommand({"AUTH", password}, auth_parser)
+                                                       : RunCommand({"AUTH", username, password}, auth_parser);
+            if (reply.type == RespType::ERROR) {
+                last_error = "AUTH failed: " + std::string(reply.AsString());
+                Disconnect();
+                return false;
+            }
+        } catch (std::runtime_error& ex) {
+            last_error = ex.what();
+            Disconnect();
+            return false;
+        }
+        ClearBuffer();
+        auth_parser.ClearObjects();
+    }
+
     std::string msg =
         "*1\r\n"
         "$4\r\n"
@@ -102,46 +249,312 @@ bool RedisClient::Connect(const char* host, int port) {
 
     CheckedSend(msg);
     RespParser resp_parser;
-    std::vector<RespObject> objects = CheckedReadResponse(resp_parser);
+    RespTape objects = CheckedReadResponse(resp_parser);
 
     if (objects.empty()) {
-        std::cerr << "ERROR: Parsed 0 objects. Connection not succesfull\n";
+        last_error = "no reply to PING";
+        Disconnect();
         return false;
     }
 
     if (objects[0].AsString() != "PONG") {
-        std::cerr << "ERROR: incorrect response to PING from Redis server\n";
+        last_error = "unexpected reply to PING: " + std::string(objects[0].AsString());
+        Disconnect();
         return false;
     }
     ClearBuffer();
     resp_parser.ClearObjects();
+
+    if (db != 0) {
+        std::string index = std::to_string(db);
+        try {
+            const RespObject& reply = RunCommand({"SELECT", index}, resp_parser);
+            if (reply.type == RespType::ERROR) {
+                last_error = "SELECT " + index + " failed: " + std::string(reply.AsString());
+                Disconnect();
+                return false;
+            }
+        } catch (std::runtime_error& ex) {
+            last_error = ex.what();
+            Disconnect();
+            return false;
+        }
+        ClearBuffer();
+        resp_parser.ClearObjects();
+    }
     return true;
 }
 
-std::vector<RespObject> RedisClient::CheckedReadResponse(RespParser& resp_parser) {
-    int avalible_buffer_space = buffer_capacity - current_offset;
-    if (avalible_buffer_space <= 5) {
-        throw std::runtime_error("ERROR: No avalible room, memory missmanaged");
+void RedisClient::ReceiveMore() {
+    if (chain.WriteSpace() < MIN_RECV_SPACE) {
+        // Only the incomplete reply moves; parsed objects keep pointing into the old segment.
+        chain.Roll(parsed_offset, MIN_RECV_SPACE);
+        parsed_offset = 0;
     }
 
-    int read =
-        recv(sock_fd,
-             &buffer[current_offset],
-             avalible_buffer_space - 1,
-             0);
-    if (read > 0) {
-        buffer[current_offset + read] = '\0';
-    } else if (read == 0) {
-      throw std::runtime_error("ERROR: Connection closed by Redis server.\n");
-
-    } else if (read == -1) {
+    int read = RecvSome(chain.WritePtr(), chain.WriteSpace());
+    if (read == 0) {
+        is_connected = false;
+        throw std::runtime_error("ERROR: Connection closed by Redis server.\n");
+    } else if (read < 0) {
+        is_connected = false;
         throw std::runtime_error("ERROR: error while reading response");
     }
+    chain.Commit(read);
+}
+
+void RedisClient::ReceiveExact(char* dest, size_t len) {
+    while (len > 0) {
+        int read = RecvSome(dest, std::min<size_t>(len, 1 << 30));
+        if (read == 0) {
+            is_connected = false;
+            throw std::runtime_error("ERROR: Connection closed by Redis server.\n");
+        } else if (read < 0) {
+            is_connected = false;
+            throw std::runtime_error("ERROR: error while reading response");
+        }
+        dest += read;
+        len -= read;
+    }
+}
+
+void RedisClient::ArmDeadline() {
+    deadline = request_timeout_ms > 0
+                   ? std::chrono::steady_clock::now() + std::chrono::milliseconds(request_timeout_ms)
+                   : std::chrono::steady_clock::time_point{};
+}
+
+bool RedisClient::WaitReadable(int timeout_ms) {
+    // TLS may already hold decrypted bytes the socket no longer reports
+    if (ssl && SSL_pending(ssl) > 0) {
+        return true;
+    }
+    return wait_readable(sock_fd, timeout_ms) != 0;
+}
+
+int RedisClient::WaitAnyReadable(RedisClient* const* clients, size_t count, int timeout_ms) {
+    std::vector<SOCKET> sockets(count);
+    for (size_t i = 0; i < count; i++) {
+        if (clients[i]->ssl && SSL_pending(clients[i]->ssl) > 0) {
+            return static_cast<int>(i);
+        }
+        sockets[i] = clients[i]->sock_fd;
+    }
+    return wait_any_readable(sockets.data(), count, timeout_ms);
+}
+
+void RedisClient::WaitForBytes() {
+    for (;;) {
+        auto remaining = std::chrono::duration_cast<std::chrono::milliseconds>(
+            deadline - std::chrono::steady_clock::now()).count();
+        if (remaining <= 0) {
+            is_connected = false;
+            throw RedisTimeoutError("ERROR: no reply from Redis within " + std::to_string(request_timeout_ms) +
+                                    " ms");
+        }
+        // 0 is a timeout or an interrupted wait; both re-check the clock
+        if (wait_readable(sock_fd, static_cast<int>(remaining)) != 0) {
+            return;
+        }
+    }
+}
+
+int RedisClient::RecvSome(char* buf, size_t len) {
+    bool timed = deadline != std::chrono::steady_clock::time_point{};
+    int read;
+    if (ssl) {
+        // SSL_read() blocks, so wait unless OpenSSL already holds decrypted bytes
+        if (timed && SSL_pending(ssl) == 0) {
+            WaitForBytes();
+        }
+        read = SSL_read(ssl, buf, static_cast<int>(std::min<size_t>(len, INT32_MAX)));
+        if (read <= 0) {
+            return SSL_get_error(ssl, read) == SSL_ERROR_ZERO_RETURN ? 0 : -1;
+        }
+    } else if (!timed) {
+        return recv(sock_fd, buf, static_cast<int>(len), 0);
+    } else {
+        // replies are usually there already; poll() only once the socket has nothing for us
+        for (;;) {
+            bool would_block;
+            read = recv_nowait(sock_fd, buf, static_cast<int>(std::min<size_t>(len, INT32_MAX)), would_block);
+            if (!would_block) {
+                break;
+            }
+            WaitForBytes();
+        }
+        if (read <= 0) {
+            return read;
+        }
+    }
+    // the timeout is about a silent server, not about how long a large reply takes in total
+    if (timed) {
+        ArmDeadline();
+    }
+    return read;
+}
+
+bool RedisClient::TlsWrite(const char* data, size_t len) {
+    while (len > 0) {
+        int written = SSL_write(ssl, data, static_cast<int>(std::min<size_t>(len, 1 << 30)));
+        if (written <= 0) {
+            std::cerr << "ERROR: TLS send failed: " << ERR_error_string(ERR_get_error(), nullptr) << "\n";
+            is_connected = false;
+            return false;
+        }
+        data += written;
+        len -= written;
+    }
+    return true;
+}
+
+bool RedisClient::SendTls(RespEncoder& package) {
+    outstanding += package.CommandCount();
+    tls_out.clear();
+    bool ok = true;
+
+    for (const RespSlice& slice : package.Slices()) {
+        const char* ptr = slice.ptr;
+        size_t len = slice.len;
+        while (ok && len > 0) {
+            // whole records of a large argument go out without being copied
+            if (tls_out.empty() && len >= TLS_RECORD_SIZE) {
+                size_t direct = len - len % TLS_RECORD_SIZE;
+                ok = TlsWrite(ptr, direct);
+                ptr += direct;
+                len -= direct;
+                continue;
+            }
+            size_t take = std::min(len, TLS_RECORD_SIZE - tls_out.size());
+            tls_out.insert(tls_out.end(), ptr, ptr + take);
+            ptr += take;
+            len -= take;
+            if (tls_out.size() == TLS_RECORD_SIZE) {
+                ok = TlsWrite(tls_out.data(), tls_out.size());
+                tls_out.clear();
+            }
+        }
+    }
+    if (ok && !tls_out.empty()) {
+        ok = TlsWrite(tls_out.data(), tls_out.size());
+    }
+    tls_out.clear();
+    package.Clear();
+    return ok;
+}
+
+void RedisClient::ReadReplies(RespParser& resp_parser, size_t count) {
+    size_t target = resp_parser.ObjectCount() + count;
+
+    // replies may already be sitting in the segment behind earlier ones
+    parsed_offset += resp_parser.ParseBuffer(chain.TailData() + parsed_offset, chain.TailUsed() - parsed_offset,
+                                             target - resp_parser.ObjectCount());
+    while (resp_parser.ObjectCount() < target) {
+        ReceiveMore();
+        parsed_offset += resp_parser.ParseBuffer(chain.TailData() + parsed_offset, chain.TailUsed() - parsed_offset,
+                                                 target - resp_parser.ObjectCount());
+    }
+    outstanding -= count;
+}
+
+size_t RedisClient::ReadPushed(RespParser& resp_parser, int timeout_ms) {
+    size_t before = resp_parser.ObjectCount();
+    parsed_offset += resp_parser.ParseBuffer(chain.TailData() + parsed_offset, chain.TailUsed() - parsed_offset);
+    if (resp_parser.ObjectCount() > before) {
+        return resp_parser.ObjectCount() - before;
+    }
+
+    // pushed messages are not replies to a request, so no deadline applies
+    deadline = std::chrono::steady_clock::time_point{};
+    // TLS may already hold decrypted bytes the socket no longer reports
+    int ready = ssl && SSL_pending(ssl) > 0 ? 1 : wait_readable(sock_fd, timeout_ms);
+    if (ready < 0) {
+        is_connected = false;
+        throw std::runtime_error("ERROR: error while waiting for the socket");
+    }
+    if (ready > 0) {
+        ReceiveMore();
+        parsed_offset += resp_parser.ParseBuffer(chain.TailData() + parsed_offset, chain.TailUsed() - parsed_offset);
+    }
+    return resp_parser.ObjectCount() - before;
+}
+
+void RedisClient::ReleaseParsed() {
+    // Keep receiving behind the parsed bytes while the tail has room: a fresh segment per call would leave
+    // every small message pinning a whole segment of its own.
+    if (chain.WriteSpace() >= MIN_RECV_SPACE) {
+        chain.DropBeforeTail();
+        return;
+    }
+    if (parsed_offset == chain.TailUsed()) {
+        ClearBuffer();
+        return;
+    }
+    // move the partial message to a fresh segment and let go of the rest
+    chain.Roll(parsed_offset, MIN_RECV_SPACE);
+    parsed_offset = 0;
+    chain.DropBeforeTail();
+}
+
+void RedisClient::ReadValueReplies(RespParser& resp_parser, size_t count, LargeValueSink& sink, size_t threshold) {
+    size_t first = resp_parser.ObjectCount();
+    size_t target = first + count;
+
+    while (resp_parser.ObjectCount() < target) {
+        const char* pos = chain.TailData() + parsed_offset;
+        size_t avail = chain.TailUsed() - parsed_offset;
+
+        // Is the next reply a bulk string whose header says it is large?
+        if (avail > 0 && *pos == '$') {
+            const char* line_end = static_cast<const char*>(std::memchr(pos, '\n', avail));
+            if (!line_end) {
+                ReceiveMore();
+                continue;
+            }
+            int64_t len = -1;
+            std::from_chars(pos + 1, line_end - 1, len);
+            if (len >= 0 && static_cast<size_t>(len) >= threshold) {
+                size_t header = line_end + 1 - pos;
+                size_t index = resp_parser.ObjectCount() - first;
+                char* dest = sink.Allocate(index, len);
+
+                // part of the payload may already be in the segment
+                size_t have = std::min<size_t>(avail - header, len);
+                std::memcpy(dest, pos + header, have);
+                parsed_offset += header + have;
+                ReceiveExact(dest + have, len - have);
+
+                // trailing \r\n
+                size_t crlf = std::min<size_t>(chain.TailUsed() - parsed_offset, 2);
+                parsed_offset += crlf;
+                if (crlf < 2) {
+                    char discard[2];
+                    ReceiveExact(discard, 2 - crlf);
+                }
+                sink.Finish(index);
+
+                RespObject obj;
+                obj.type = RespType::BULK_STRING;
+                obj.str_view.ptr = dest;
+                obj.str_view.len = len;
+                resp_parser.PushObject(obj);
+                continue;
+            }
+        }
 
-    std::string raw_data(buffer + current_offset, read);
-    resp_parser.ParseBuffer(&buffer[current_offset], read);
-    current_offset += read;
-    std::vector<RespObject> objects = resp_parser.GetObjects();
+        size_t consumed = avail ? resp_parser.ParseBuffer(pos, avail, 1) : 0;
+        if (consumed == 0) {
+            ReceiveMore();
+            continue;
+        }
+        parsed_offset += consumed;
+    }
+    outstanding -= count;
+}
+
+RespTape RedisClient::CheckedReadResponse(RespParser& resp_parser) {
+    ReadReplies(resp_parser, 1);
+    RespTape objects = resp_parser.GetObjects();
 
     if (objects.empty()) {
         throw std::runtime_error("ERROR: Parsed 0 objects. Buffer might be incomplete.");
@@ -151,10 +564,91 @@ std::vector<RespObject> RedisClient::CheckedReadResponse(RespParser& resp_parser
 }
 
 bool RedisClient::CheckedSend(const std::string& package) {
-    if (send(sock_fd, package.c_str(), package.size(), 0) == -1) {
+    ArmDeadline();
+    if (ssl && !ktls_send) {
+        if (!TlsWrite(package.data(), package.size())) {
+            return false;
+        }
+    } else if (send(sock_fd, package.c_str(), package.size(), 0) == -1) {
         std::cerr << "ERROR: Socket send failed error: " ;
         return false;
     }
+    // callers send exactly one command per package
+    outstanding++;
+    return true;
+}
+
+bool RedisClient::SendEncoded(RespEncoder& package) {
+    ArmDeadline();
+    if (ssl && !ktls_send) {
+        return SendTls(package);
+    }
+    // plain TCP, or kTLS: the kernel encrypts whatever sendmsg() hands it
+    outstanding += package.CommandCount();
+    const std::vector<RespSlice>& slices = package.Slices();
+    size_t index = 0;
+    size_t skip = 0; // bytes of slices[index] that were already sent
+
+    while (index < slices.size()) {
+        size_t batch = std::min(MAX_SEND_SLICES, slices.size() - index);
+#ifdef _WIN32
+        WSABUF bufs[MAX_SEND_SLICES];
+        for (size_t i = 0; i < batch; i++) {
+            bufs[i].buf = const_cast<char*>(slices[index + i].ptr);
+            bufs[i].len = static_cast<ULONG>(slices[index + i].len);
+        }
+        bufs[0].buf += skip;
+        bufs[0].len -= static_cast<ULONG>(skip);
+        DWORD sent_bytes = 0;
+        if (WSASend(sock_fd, bufs, static_cast<DWORD>(batch), &sent_bytes, 0, nullptr, nullptr) != 0) {
+            std::cerr << "ERROR: Socket send failed error: " << GET_SOCKET_ERROR() << "\n";
+            package.Clear();
+            return false;
+        }
+        size_t sent = sent_bytes;
+#else
+        iovec bufs[MAX_SEND_SLICES];
+        for (size_t i = 0; i < batch; i++) {
+            bufs[i].iov_base = const_cast<char*>(slices[index + i].ptr);
+            bufs[i].iov_len = slices[index + i].len;
+        }
+        bufs[0].iov_base = static_cast<char*>(bufs[0].iov_base) + skip;
+        bufs[0].iov_len -= skip;
+
+        msghdr msg{};
+        msg.msg_iov = bufs;
+        msg.msg_iovlen = batch;
+        int flags = 0;
+#ifdef MSG_NOSIGNAL
+        flags |= MSG_NOSIGNAL;
+#endif
+        ssize_t result = sendmsg(sock_fd, &msg, flags);
+        if (result < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            std::cerr << "ERROR: Socket send failed error: " << GET_SOCKET_ERROR() << "\n";
+            is_connected = false;
+            package.Clear();
+            return false;
+        }
+        size_t sent = static_cast<size_t>(result);
+#endif
+        // advance over fully written slices
+        while (sent > 0) {
+            size_t left = slices[index].len - skip;
+            if (sent >= left) {
+                sent -= left;
+                skip = 0;
+                index++;
+            } else {
+                skip += sent;
+                sent = 0;
+            }
+        }
+    }
+
+    package.Clear();
     return true;
 }
 
@@ -162,7 +656,7 @@ std::vector<std::string_view> RedisClient::RedisScan(std::string& query, RespPar
     parser.SqlToResp(query);
 
     if (!is_connected) { //should be done by higher level duckdb extension function calls, leaving for now
-        bool conn_result = Connect(host.c_str(), port);
+        bool conn_result = Open();
         if (!conn_result) {
             std::cerr << "ERROR: connection failed, unhandeled case.\n";
             return {};
@@ -172,7 +666,8 @@ std::vector<std::string_view> RedisClient::RedisScan(std::string& query, RespPar
     int cursor = 0;
     std::vector<std::string_view> intermediate_buffer;
     while (true) {
-        if (!CheckedSend(parser.BuildScan(std::to_string(cursor), query))) {
+        encoder.EncodeScan(std::to_string(cursor), query);
+        if (!SendEncoded(encoder)) {
             std::cerr << "ERROR: send failed at cursor " << cursor;
             return {};
         }
@@ -183,16 +678,19 @@ std::vector<std::string_view> RedisClient::RedisScan(std::string& query, RespPar
           std::cerr << "ERROR: no objects passed back when expecting at least one";
           return {};
         }
-        if(objects[0].AsString() == "0"){
+        // the parser keeps earlier pages, the reply to this SCAN is the last object
+        const RespObject& reply = objects.back();
+        if(reply.type != RespType::ARRAY || reply.children.size() < 2){
+          std::cerr << "ERROR: unexpected SCAN reply shape";
           return {};
         }
 
-        std::vector<RespObject>& results = objects[0].children[1].children;
+        const RespTape& results = reply.children[1].children;
         for(auto& it: results){
           intermediate_buffer.push_back(it.AsString());
         }
 
-        std::string_view new_cursor = objects[0].children[0].AsString();
+        std::string_view new_cursor = reply.children[0].AsString();
         if(new_cursor == "0"){
           break;
         }
@@ -211,15 +709,15 @@ std::string_view RedisClient::RedisGet(const std::string& key, RespParser& parse
     parser.ClearObjects();
     ClearBuffer();
     if (!is_connected) { //should be done by higher level duckdb extension function calls, leaving for now
-        bool conn_result = Connect(host.c_str(), port);
+        bool conn_result = Open();
         if (!conn_result) {
             std::cerr << "ERROR: connection failed, unhandeled case.\n";
             return "";
         }
     }
 
-    std::string msg = parser.BuildGet(key);
-    if(!CheckedSend(msg)){
+    encoder.EncodeGet(key);
+    if(!SendEncoded(encoder)){
       std::cerr << "ERROR: Could not send a Get Command for key" <<key;
       return "";
     }
@@ -235,3 +733,93 @@ std::string_view RedisClient::RedisGet(const std::string& key, RespParser& parse
     }
     return objects[0].AsString();
 }
+
+const RespTape& RedisClient::RedisGetPipelined(const std::vector<std::string_view>& keys, RespParser& parser,
+                                                             LargeValueSink* sink, size_t large_threshold){
+    SendGetPipeline(keys);
+    return ReadGetPipeline(keys.size(), parser, sink, large_threshold);
+}
+
+void RedisClient::SendGetPipeline(const std::vector<std::string_view>& keys){
+    ClearBuffer();
+    if (!is_connected) {
+        if (!Open()) {
+            throw std::runtime_error("ERROR: connection failed while pipelining GET");
+        }
+    }
+    if (keys.empty()) {
+        return;
+    }
+
+    encoder.Clear();
+    for (const auto& key : keys) {
+        encoder.EncodeGet(key);
+    }
+    if (!SendEncoded(encoder)) {
+        throw std::runtime_error("ERROR: could not send pipelined GET commands");
+    }
+}
+
+const RespTape& RedisClient::ReadGetPipeline(size_t count, RespParser& parser,
+                                                           LargeValueSink* sink, size_t large_threshold){
+    parser.ClearObjects();
+    if (count == 0) {
+        return parser.Objects();
+    }
+    if (sink) {
+        ReadValueReplies(parser, count, *sink, large_threshold);
+    } else {
+        ReadReplies(parser, count);
+    }
+    return parser.Objects();
+}
+
+std::string RedisClient::ScriptSha1(const std::string& script) {
+    unsigned char digest[EVP_MAX_MD_SIZE];
+    unsigned int digest_len = 0;
+    if (EVP_Digest(script.data(), script.size(), digest, &digest_len, EVP_sha1(), nullptr) != 1) {
+        throw std::runtime_error("ERROR: could not hash Lua script");
+    }
+
+    static const char hex[] = "0123456789abcdef";
+    std::string result;
+    result.reserve(digest_len * 2);
+    for (unsigned int i = 0; i < digest_len; i++) {
+        result += hex[digest[i] >> 4];
+        result += hex[digest[i] & 0xF];
+    }
+    return result;
+}
+
+const RespObject& RedisClient::RunCommand(const std::vector<std::string_view>& args, RespParser& parser){
+    if (!is_connected) {
+        if (!Open()) {
+            throw std::runtime_error("ERROR: connection failed while sending " + std::string(args[0]));
+        }
+    }
+    parser.ClearObjects();
+    ClearBuffer();
+    encoder.AppendCommand(args);
+    if (!SendEncoded(encoder)) {
+        throw std::runtime_error("ERROR: could not send " + std::string(args[0]));
+    }
+    ReadReplies(parser, 1);
+    return parser.Objects().back();
+}
+
+const RespObject& RedisClient::EvalCached(const std::string& script, const std::string& sha1,
+                                          const std::vector<std::string_view>& args, RespParser& parser){
+    std::vector<std::string_view> command = {"EVALSHA", sha1, "0"};
+    command.insert(command.end(), args.begin(), args.end());
+
+    const RespObject* reply = &RunCommand(command, parser);
+    if (reply->type == RespType::ERROR && reply->AsString().substr(0, 8) == "NOSCRIPT") {
+        // first use on this server (or after SCRIPT FLUSH): upload once, then retry
+        const RespObject& loaded = RunCommand({"SCRIPT", "LOAD", script}, parser);
+        if (loaded.type == RespType::ERROR) {
+            throw std::runtime_error("ERROR: SCRIPT LOAD failed: " + std::string(loaded.AsString()));
+        }
+        reply = &RunCommand(command, parser);
+    }
+    return *reply;
+}
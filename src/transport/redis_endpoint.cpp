@@ -0,0 +1,187 @@
+/*
+  redis_endpoint.cpp
+*/
+
+#include "transport/redis_endpoint.hpp"
+#include <charconv>
+#include <cstdint>
+#include <stdexcept>
+
+static std::string_view Trim(std::string_view text) {
+    while (!text.empty() && (text.front() == ' ' || text.front() == '\t')) {
+        text.remove_prefix(1);
+    }
+    while (!text.empty() && (text.back() == ' ' || text.back() == '\t')) {
+        text.remove_suffix(1);
+    }
+    return text;
+}
+
+static int ParseNumber(std::string_view text, int min, int max, const char* error) {
+    int value = 0;
+    auto [ptr, ec] = std::from_chars(text.data(), text.data() + text.size(), value);
+    if (text.empty() || ec != std::errc{} || ptr != text.data() + text.size() || value < min || value > max) {
+        throw std::invalid_argument(error);
+    }
+    return value;
+}
+
+static int HexDigit(char c) {
+    if (c >= '0' && c <= '9') {
+        return c - '0';
+    }
+    if (c >= 'a' && c <= 'f') {
+        return c - 'a' + 10;
+    }
+    if (c >= 'A' && c <= 'F') {
+        return c - 'A' + 10;
+    }
+    return -1;
+}
+
+// Credentials are percent-encoded in URLs ("p%40ss" for "p@ss"), so they may contain ':', '@' and '/'.
+static std::string PercentDecode(std::string_view text) {
+    std::string result;
+    result.reserve(text.size());
+    for (size_t i = 0; i < text.size(); i++) {
+        if (text[i] != '%') {
+            result += text[i];
+            continue;
+        }
+        int high = i + 2 < text.size() ? HexDigit(text[i + 1]) : -1;
+        int low = high >= 0 ? HexDigit(text[i + 2]) : -1;
+        if (low < 0) {
+            throw std::invalid_argument("Invalid percent-encoding in the credentials");
+        }
+        result += char(high * 16 + low);
+        i += 2;
+    }
+    return result;
+}
+
+RedisEndpoint ParseEndpoint(std::string_view text) {
+    text = Trim(text);
+    if (text.empty()) {
+        throw std::invalid_argument("empty Redis address");
+    }
+
+    RedisEndpoint endpoint;
+    if (text.substr(0, 7) == "unix://") {
+        text.remove_prefix(7);
+        size_t query = text.find('?');
+        if (query != std::string_view::npos) {
+            std::string_view option = text.substr(query + 1);
+            if (option.substr(0, 3) != "db=") {
+                throw std::invalid_argument("unix:// only supports the '?db=N' option");
+            }
+            endpoint.db = ParseNumber(option.substr(3), 0, INT32_MAX, "Database must be a valid number");
+            text = text.substr(0, query);
+        }
+        if (text.empty() || text.front() != '/') {
+            throw std::invalid_argument("Invalid format. Expected 'unix:///path/to/redis.sock'");
+        }
+        endpoint.unix_path = std::string(text);
+        return endpoint;
+    }
+    if (text.substr(0, 9) == "rediss://") {
+        endpoint.tls = true;
+        text.remove_prefix(9);
+    } else if (text.substr(0, 8) == "redis://") {
+        text.remove_prefix(8);
+    }
+
+    // user:password@ or :password@ (requirepass without ACL users)
+    size_t at = text.substr(0, text.find('/')).rfind('@');
+    if (at != std::string_view::npos) {
+        std::string_view credentials = text.substr(0, at);
+        size_t colon = credentials.find(':');
+        if (colon == std::string_view::npos) {
+            endpoint.password = PercentDecode(credentials);
+        } else {
+            endpoint.username = PercentDecode(credentials.substr(0, colon));
+            endpoint.password = PercentDecode(credentials.substr(colon + 1));
+        }
+        text.remove_prefix(at + 1);
+    }
+
+    // redis://host:port/db
+    size_t slash = text.find('/');
+    if (slash != std::string_view::npos) {
+        std::string_view db = text.substr(slash + 1);
+        if (!db.empty()) {
+            endpoint.db = ParseNumber(db, 0, INT32_MAX, "Database must be a valid number");
+        }
+        text = text.substr(0, slash);
+    }
+    if (text.empty()) {
+        throw std::invalid_argument("Invalid format. Expected 'HOST:PORT'");
+    }
+
+    std::string_view port;
+    if (text.front() == '[') {
+        // [IPv6]:port
+        size_t close = text.find(']');
+        if (close == std::string_view::npos || close == 1) {
+            throw std::invalid_argument("Invalid IPv6 address. Expected '[ADDRESS]:PORT'");
+        }
+        std::string_view rest = text.substr(close + 1);
+        if (!rest.empty()) {
+            if (rest.front() != ':') {
+                throw std::invalid_argument("Invalid IPv6 address. Expected '[ADDRESS]:PORT'");
+            }
+            port = rest.substr(1);
+        }
+        endpoint.host = std::string(text.substr(1, close - 1));
+    } else {
+        size_t colon = text.rfind(':');
+        if (colon != std::string_view::npos && text.find(':') != colon) {
+            // more than one colon: a bare IPv6 address without a port
+            endpoint.host = std::string(text);
+            return endpoint;
+        }
+        if (colon != std::string_view::npos) {
+            port = text.substr(colon + 1);
+            text = text.substr(0, colon);
+        }
+        endpoint.host = std::string(text);
+        if (colon != std::string_view::npos && port.empty()) {
+            throw std::invalid_argument("Port must be a valid number");
+        }
+    }
+    if (!port.empty()) {
+        endpoint.port = ParseNumber(port, 1, 65535, "Port must be a valid number");
+    }
+    if (endpoint.host.empty()) {
+        throw std::invalid_argument("Invalid format. Expected 'HOST:PORT'");
+    }
+    return endpoint;
+}
+
+std::string RedisEndpoint::ToString() const {
+    std::string text;
+    if (IsUnix()) {
+        text = "unix://" + unix_path;
+        return db == 0 ? text : text + "?db=" + std::to_string(db);
+    }
+    text = tls ? "rediss://" : "";
+    // IPv6 addresses need brackets so the port stays recognisable
+    text += host.find(':') != std::string::npos ? "[" + host + "]" : host;
+    text += ":" + std::to_string(port);
+    return db == 0 ? text : text + "/" + std::to_string(db);
+}
+
+std::vector<RedisEndpoint> ParseEndpointList(std::string_view text) {
+    std::vector<RedisEndpoint> result;
+    while (!text.empty()) {
+        size_t comma = text.find(',');
+        std::string_view item = Trim(text.substr(0, comma));
+        if (!item.empty()) {
+            result.push_back(ParseEndpoint(item));
+        }
+        if (comma == std::string_view::npos) {
+            break;
+        }
+        text.remove_prefix(comma + 1);
+    }
+    return result;
+}
@@ -0,0 +1,361 @@
+/*
+  replica_router.cpp
+*/
+
+#include "transport/replica_router.hpp"
+#include <algorithm>
+#include <charconv>
+
+// Returns the value of "key:value" in an INFO reply, or an empty view.
+static std::string_view InfoField(std::string_view info, std::string_view key) {
+    size_t pos = 0;
+    while (pos < info.size()) {
+        size_t line_end = info.find('\n', pos);
+        std::string_view line = info.substr(pos, line_end == std::string_view::npos ? std::string_view::npos : line_end - pos);
+        if (!line.empty() && line.back() == '\r') {
+            line.remove_suffix(1);
+        }
+        if (line.size() > key.size() && line.substr(0, key.size()) == key && line[key.size()] == ':') {
+            return line.substr(key.size() + 1);
+        }
+        if (line_end == std::string_view::npos) {
+            break;
+        }
+        pos = line_end + 1;
+    }
+    return {};
+}
+
+static RedisNodeRef MakeNode(const RedisEndpoint& endpoint, bool primary) {
+    auto node = std::make_shared<RedisNode>();
+    node->endpoint = endpoint;
+    node->primary = primary;
+    node->healthy = primary;
+    node->pool = std::make_shared<ConnectionPool>(endpoint);
+    return node;
+}
+
+static int64_t InfoNumber(std::string_view info, std::string_view key) {
+    std::string_view text = InfoField(info, key);
+    int64_t value = -1;
+    std::from_chars(text.data(), text.data() + text.size(), value);
+    return value;
+}
+
+ReplicaRouter::ReplicaRouter() {
+    primary = MakeNode(RedisEndpoint{}, true);
+}
+
+ReplicaRouter::~ReplicaRouter() {
+    {
+        std::lock_guard<std::mutex> guard(lock);
+        stopping = true;
+    }
+    probe_wakeup.notify_all();
+    if (prober.joinable()) {
+        prober.join();
+    }
+}
+
+void ReplicaRouter::SetPrimary(const RedisEndpoint& endpoint) {
+    std::lock_guard<std::mutex> guard(lock);
+    primary = MakeNode(endpoint, true);
+    replicas.clear();
+    discovered_replicas.clear();
+    discovered = {};
+}
+
+RedisNodeRef ReplicaRouter::PrimaryNode() {
+    std::lock_guard<std::mutex> guard(lock);
+    return primary;
+}
+
+RedisRouteRef ReplicaRouter::Route(const std::vector<RedisEndpoint>& endpoints, int64_t max_lag_bytes,
+                                   const ReadPolicy& policy) {
+    auto route = std::make_shared<RedisRoute>();
+    route->max_lag_bytes = max_lag_bytes;
+    route->policy = policy;
+
+    std::lock_guard<std::mutex> guard(lock);
+    route->primary = primary;
+    bool added = false;
+    for (auto endpoint : endpoints) {
+        // replicas listed without credentials use the primary's
+        if (endpoint.password.empty()) {
+            endpoint.username = primary->endpoint.username;
+            endpoint.password = primary->endpoint.password;
+        }
+        auto known = std::find_if(replicas.begin(), replicas.end(),
+                                  [&](const RedisNodeRef& node) { return node->endpoint == endpoint; });
+        if (known == replicas.end()) {
+            replicas.push_back(MakeNode(endpoint, false));
+            known = replicas.end() - 1;
+            added = true;
+        }
+        route->replicas.push_back(*known);
+    }
+    if (added) {
+        if (!prober.joinable()) {
+            prober = std::thread([this]() { ProbeLoop(); });
+        }
+        probe_requested = true;
+        probe_wakeup.notify_all();
+    }
+    return route;
+}
+
+RedisRouteRef ReplicaRouter::Route(const RedisNodeRef& node, const ReadPolicy& policy) {
+    auto route = std::make_shared<RedisRoute>();
+    route->primary = node;
+    route->policy = policy;
+    return route;
+}
+
+RedisNodeRef ReplicaRouter::EndpointNode(const RedisEndpoint& endpoint) {
+    std::lock_guard<std::mutex> guard(lock);
+    auto known = std::find_if(endpoint_nodes.begin(), endpoint_nodes.end(),
+                              [&](const RedisNodeRef& node) { return node->endpoint == endpoint; });
+    if (known != endpoint_nodes.end()) {
+        return *known;
+    }
+    endpoint_nodes.push_back(MakeNode(endpoint, true));
+    return endpoint_nodes.back();
+}
+
+RedisNodeRef ReplicaRouter::NewNode(const RedisEndpoint& endpoint) {
+    return MakeNode(endpoint, true);
+}
+
+std::vector<RedisEndpoint> ReplicaRouter::DiscoverReplicas() {
+    RedisNodeRef node;
+    {
+        std::lock_guard<std::mutex> guard(lock);
+        auto now = std::chrono::steady_clock::now();
+        if (discovered != std::chrono::steady_clock::time_point{} && now - discovered < DISCOVERY_INTERVAL) {
+            return discovered_replicas;
+        }
+        node = primary;
+    }
+    std::vector<RedisEndpoint> found;
+    {
+        PooledClient client(node->pool);
+        RespParser parser;
+        // ROLE on a primary: ["master", offset, [[ip, port, offset], ...]]
+        const RespObject& reply = client->RunCommand({"ROLE"}, parser);
+        if (reply.type != RespType::ARRAY || reply.children.size() < 3 || reply.children[0].AsString() != "master") {
+            throw std::runtime_error("ERROR: replica discovery needs redis_connect() to point at a primary");
+        }
+        for (const auto& replica : reply.children[2].children) {
+            if (replica.children.size() < 2) {
+                continue;
+            }
+            // replicas are reached the same way as the primary (TLS, database, credentials)
+            RedisEndpoint endpoint;
+            endpoint.tls = node->endpoint.tls;
+            endpoint.db = node->endpoint.db;
+            endpoint.username = node->endpoint.username;
+            endpoint.password = node->endpoint.password;
+            endpoint.host = std::string(replica.children[0].AsString());
+            std::string_view port = replica.children[1].AsString();
+            std::from_chars(port.data(), port.data() + port.size(), endpoint.port);
+            found.push_back(endpoint);
+        }
+        client->ClearBuffer();
+    }
+
+    std::lock_guard<std::mutex> guard(lock);
+    // the primary may have changed in the meantime; its replicas are discovered next time
+    if (node == primary) {
+        discovered_replicas = found;
+        discovered = std::chrono::steady_clock::now();
+    }
+    return found;
+}
+
+std::string_view ReplicaRouter::ProbeInfo(RedisNode& node, RespParser& parser) {
+    try {
+        if (!node.probe || !node.probe->IsConnected()) {
+            node.probe = std::make_unique<RedisClient>();
+            node.probe->connection_timeout = static_cast<float>(PROBE_TIMEOUT_MS) / 1000;
+            node.probe->request_timeout_ms = PROBE_TIMEOUT_MS;
+            if (!node.probe->Connect(node.endpoint)) {
+                node.probe.reset();
+                return {};
+            }
+        }
+        const RespObject& reply = node.probe->RunCommand({"INFO", "replication"}, parser);
+        return reply.type == RespType::ERROR ? std::string_view() : reply.AsString();
+    } catch (...) {
+        node.probe.reset();
+        return {};
+    }
+}
+
+void ReplicaRouter::CheckReplica(RedisNode& node, int64_t primary_offset) {
+    RespParser parser;
+    std::string_view info = ProbeInfo(node, parser);
+    bool healthy = false;
+    int64_t lag = -1;
+
+    std::string_view role = InfoField(info, "role");
+    if (role == "master") {
+        // listed a primary as replica: it is never behind
+        healthy = true;
+        lag = 0;
+    } else if (role == "slave" && InfoField(info, "master_link_status") == "up") {
+        healthy = true;
+        int64_t offset = InfoNumber(info, "slave_repl_offset");
+        // without the primary's offset the replica keeps its last known lag
+        if (primary_offset >= 0 && offset >= 0) {
+            lag = std::max<int64_t>(0, primary_offset - offset);
+        }
+    }
+    if (node.probe) {
+        node.probe->ClearBuffer();
+    }
+
+    std::lock_guard<std::mutex> guard(lock);
+    node.healthy = healthy;
+    if (lag >= 0) {
+        node.lag_bytes = lag;
+    }
+}
+
+void ReplicaRouter::ProbeLoop() {
+    std::unique_lock<std::mutex> guard(lock);
+    while (!stopping) {
+        RedisNodeRef current_primary = primary;
+        std::vector<RedisNodeRef> nodes = replicas;
+        guard.unlock();
+
+        /*
+          The primary is asked first, so a replica's lag is measured against an offset that is,
+          if anything, older than its own: lag is never overestimated. Unlike
+          master_last_io_seconds_ago, offsets do not grow while the primary is idle.
+        */
+        int64_t primary_offset = -1;
+        if (!nodes.empty()) {
+            RespParser parser;
+            primary_offset = InfoNumber(ProbeInfo(*current_primary, parser), "master_repl_offset");
+            if (current_primary->probe) {
+                current_primary->probe->ClearBuffer();
+            }
+        }
+        for (auto& node : nodes) {
+            CheckReplica(*node, primary_offset);
+        }
+
+        guard.lock();
+        probe_wakeup.wait_for(guard, CHECK_INTERVAL, [this]() { return stopping || probe_requested; });
+        probe_requested = false;
+    }
+}
+
+std::vector<RedisNodeRef> ReplicaRouter::EligibleReplicas(const RedisRoute& route) {
+    std::vector<RedisNodeRef> result;
+    for (auto& node : route.replicas) {
+        if (node->healthy && (route.max_lag_bytes < 0 || node->lag_bytes <= route.max_lag_bytes)) {
+            result.push_back(node);
+        }
+    }
+    return result;
+}
+
+RedisNodeRef ReplicaRouter::PickScanNode(const RedisRoute& route) {
+    std::lock_guard<std::mutex> guard(lock);
+    std::vector<RedisNodeRef> eligible = EligibleReplicas(route);
+    if (eligible.empty()) {
+        return route.primary;
+    }
+    return *std::min_element(eligible.begin(), eligible.end(), [](const RedisNodeRef& a, const RedisNodeRef& b) {
+        return a->latency_ms * (1 + a->inflight) < b->latency_ms * (1 + b->inflight);
+    });
+}
+
+std::vector<std::pair<RedisNodeRef, size_t>> ReplicaRouter::SplitReads(const RedisRoute& route, size_t count) {
+    std::lock_guard<std::mutex> guard(lock);
+    std::vector<RedisNodeRef> nodes = EligibleReplicas(route);
+    if (nodes.empty()) {
+        nodes.push_back(route.primary);
+    }
+
+    /*
+      Latency is measured per pipeline, so a node that gets a bigger share also
+      reports a longer round trip. The split therefore settles where all nodes
+      finish their share at about the same time.
+    */
+    std::vector<double> weights;
+    double total = 0;
+    for (auto& node : nodes) {
+        double weight = 1.0 / (std::max(node->latency_ms, 0.05) * (1.0 + static_cast<double>(node->inflight)));
+        weights.push_back(weight);
+        total += weight;
+    }
+
+    std::vector<std::pair<RedisNodeRef, size_t>> shares;
+    size_t assigned = 0;
+    for (size_t i = 0; i < nodes.size(); i++) {
+        size_t share = static_cast<size_t>(static_cast<double>(count) * weights[i] / total);
+        shares.emplace_back(nodes[i], share);
+        assigned += share;
+    }
+    // rounding leftovers go to the node with the highest weight
+    size_t best = std::max_element(weights.begin(), weights.end()) - weights.begin();
+    shares[best].second += count - assigned;
+
+    std::vector<std::pair<RedisNodeRef, size_t>> result;
+    for (auto& share : shares) {
+        if (share.second > 0) {
+            share.first->inflight += share.second;
+            result.push_back(std::move(share));
+        }
+    }
+    return result;
+}
+
+void ReplicaRouter::FinishReads(const RedisNodeRef& node, size_t count, double elapsed_ms) {
+    std::lock_guard<std::mutex> guard(lock);
+    node->inflight -= std::min(count, node->inflight);
+    if (elapsed_ms >= 0) {
+        node->latency_ms = LATENCY_ALPHA * elapsed_ms + (1 - LATENCY_ALPHA) * node->latency_ms;
+        node->samples[node->sample_count++ % node->samples.size()] = elapsed_ms;
+    }
+}
+
+void ReplicaRouter::MarkFailed(const RedisNodeRef& node) {
+    std::lock_guard<std::mutex> guard(lock);
+    if (!node->primary) {
+        node->healthy = false;
+    }
+}
+
+double ReplicaRouter::HedgeDelay(const RedisNodeRef& node) {
+    std::array<double, 64> recent;
+    size_t count;
+    {
+        std::lock_guard<std::mutex> guard(lock);
+        if (node->sample_count < MIN_HEDGE_SAMPLES) {
+            return -1;
+        }
+        recent = node->samples;
+        count = std::min(node->sample_count, recent.size());
+    }
+    auto p95 = recent.begin() + (count * 95) / 100;
+    std::nth_element(recent.begin(), p95, recent.begin() + count);
+    return *p95;
+}
+
+RedisNodeRef ReplicaRouter::PickAlternative(const RedisRoute& route, const RedisNodeRef& avoid) {
+    std::lock_guard<std::mutex> guard(lock);
+    RedisNodeRef best;
+    for (auto& node : EligibleReplicas(route)) {
+        if (node != avoid && (!best || node->latency_ms * (1 + node->inflight) < best->latency_ms * (1 + best->inflight))) {
+            best = node;
+        }
+    }
+    if (best) {
+        return best;
+    }
+    // no other replica: the primary (a second connection when 'avoid' is the primary itself)
+    return route.primary;
+}
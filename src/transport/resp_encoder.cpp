@@ -0,0 +1,126 @@
+/*
+  resp_encoder.cpp
+*/
+
+#include "transport/resp_encoder.hpp"
+#include <charconv>
+#include <cstring>
+
+void RespEncoder::AppendOwned(const char* data, size_t len) {
+    if (len == 0) {
+        return;
+    }
+    size_t offset = out.size();
+    out.insert(out.end(), data, data + len);
+    total_bytes += len;
+
+    // Extend the previous piece when it also lives in the output buffer.
+    if (!pieces.empty() && pieces.back().external == nullptr &&
+        pieces.back().offset + pieces.back().len == offset) {
+        pieces.back().len += len;
+        return;
+    }
+    pieces.push_back({nullptr, offset, len});
+}
+
+void RespEncoder::AppendExternal(const char* data, size_t len) {
+    pieces.push_back({data, 0, len});
+    total_bytes += len;
+}
+
+void RespEncoder::AppendRaw(std::string_view fragment) {
+    AppendOwned(fragment.data(), fragment.size());
+}
+
+void RespEncoder::AppendArrayHeader(size_t count) {
+    char header[24];
+    header[0] = '*';
+    auto [ptr, ec] = std::to_chars(header + 1, header + sizeof(header) - 2, count);
+    *ptr++ = '\r';
+    *ptr++ = '\n';
+    AppendOwned(header, ptr - header);
+}
+
+void RespEncoder::AppendBulk(std::string_view arg) {
+    char header[24];
+    header[0] = '$';
+    auto [ptr, ec] = std::to_chars(header + 1, header + sizeof(header) - 2, arg.size());
+    *ptr++ = '\r';
+    *ptr++ = '\n';
+    AppendOwned(header, ptr - header);
+
+    if (arg.size() <= INLINE_ARG_LIMIT) {
+        AppendOwned(arg.data(), arg.size());
+    } else {
+        AppendExternal(arg.data(), arg.size());
+    }
+    AppendOwned("\r\n", 2);
+}
+
+void RespEncoder::AppendBulk(int64_t value) {
+    char digits[24];
+    auto [ptr, ec] = std::to_chars(digits, digits + sizeof(digits), value);
+    // the digits live on the stack, so they always have to be copied
+    char header[8];
+    header[0] = '$';
+    auto [hptr, hec] = std::to_chars(header + 1, header + sizeof(header) - 2, ptr - digits);
+    *hptr++ = '\r';
+    *hptr++ = '\n';
+    AppendOwned(header, hptr - header);
+    AppendOwned(digits, ptr - digits);
+    AppendOwned("\r\n", 2);
+}
+
+void RespEncoder::AppendCommand(const std::vector<std::string_view>& args) {
+    AppendArrayHeader(args.size());
+    for (const auto& arg : args) {
+        AppendBulk(arg);
+    }
+    EndCommand();
+}
+
+void RespEncoder::EncodeGet(std::string_view key) {
+    EncodeKeyCommand(resp::GET_PREFIX.View(), key);
+}
+
+void RespEncoder::EncodeKeyCommand(std::string_view prefix, std::string_view key) {
+    AppendRaw(prefix);
+    AppendBulk(key);
+    EndCommand();
+}
+
+void RespEncoder::EncodeRange(std::string_view prefix, std::string_view key, int64_t start, int64_t stop) {
+    AppendRaw(prefix);
+    AppendBulk(key);
+    AppendBulk(start);
+    AppendBulk(stop);
+    EndCommand();
+}
+
+void RespEncoder::EncodeScan(std::string_view cursor, std::string_view pattern, size_t count) {
+    AppendRaw(resp::SCAN_PREFIX.View());
+    AppendBulk(cursor);
+    AppendRaw(resp::MATCH_ARG.View());
+    AppendBulk(pattern);
+    AppendRaw(resp::COUNT_ARG.View());
+    AppendBulk(static_cast<int64_t>(count));
+    EndCommand();
+}
+
+const std::vector<RespSlice>& RespEncoder::Slices() {
+    slices.clear();
+    slices.reserve(pieces.size());
+    for (const auto& piece : pieces) {
+        const char* ptr = piece.external ? piece.external : out.data() + piece.offset;
+        slices.push_back({ptr, piece.len});
+    }
+    return slices;
+}
+
+void RespEncoder::Clear() {
+    out.clear();
+    pieces.clear();
+    slices.clear();
+    command_count = 0;
+    total_bytes = 0;
+}
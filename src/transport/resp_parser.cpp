@@ -5,41 +5,62 @@
 #include <iostream>
 #include <stdexcept>
 
+// finds the next \r\n inside [cursor, end). Payloads may be binary, so no strstr.
+static const char* FindCrlf(const char* cursor, const char* end) {
+    while (cursor < end) {
+        const char* cr = static_cast<const char*>(std::memchr(cursor, '\r', end - cursor));
+        if (!cr || cr + 1 >= end) {
+            return nullptr;
+        }
+        if (cr[1] == '\n') {
+            return cr;
+        }
+        cursor = cr + 1;
+    }
+    return nullptr;
+}
+
 // reads until \r\n and returns the number found
 template <typename T>
 T RespParser::ParseNumeric(const char*& cursor, const char* end) {
-    const char* line_end = std::strstr(cursor, "\r\n");
-    if (!line_end || line_end > end) {
+    const char* line_end = FindCrlf(cursor, end);
+    if (!line_end) {
         throw std::runtime_error("Incomplete buffer");
     }
 
     T value = 0;
     auto result = std::from_chars(cursor, line_end, value);
-
-    if (result.ec != std::errc()) {
-        // Handle parsing error (e.g., invalid characters)
-        // It's often good to throw here or return a default/error code
+    if (result.ec != std::errc() || result.ptr != line_end) {
+        // a complete line that is not a number (or does not fit): no amount of further bytes will fix it
+        throw RespProtocolError("ERROR: invalid number in Redis reply: " + std::string(cursor, line_end));
     }
 
     cursor = line_end + 2;
     return value;
 }
 
-void RespParser::ParseBuffer(const char* buffer, size_t length) {
+size_t RespParser::ParseBuffer(const char* buffer, size_t length, size_t max_objects) {
     const char* cursor = buffer;
     const char* end = buffer + length;
 
-    while (cursor < end) {
+    for (size_t parsed = 0; cursor < end && parsed < max_objects; parsed++) {
+        const char* object_start = cursor;
         try {
             RespObjects.push_back(ParseNext(cursor, end));
+        } catch (RespProtocolError&) {
+            throw;
         } catch (...) {
-            break;
+            // incomplete object: leave it for the next call once more bytes arrived
+            return object_start - buffer;
         }
     }
+    return cursor - buffer;
 }
 
 RespObject RespParser::ParseNext(const char*& cursor, const char* end) {
-    if (cursor >= end) return {};
+    if (cursor >= end) {
+        throw std::runtime_error("Incomplete buffer");
+    }
 
     char typeByte = *cursor;
     cursor++;
@@ -49,7 +70,7 @@ RespObject RespParser::ParseNext(const char*& cursor, const char* end) {
     switch (typeByte) {
         case ':': {
             obj.type = RespType::INT;
-            obj.int_val = ParseNumeric<int>(cursor, end);
+            obj.int_val = ParseNumeric<int64_t>(cursor, end);
             break;
         }
         case ',': {
@@ -59,8 +80,8 @@ RespObject RespParser::ParseNext(const char*& cursor, const char* end) {
         }
         case '+': {
             obj.type = RespType::SIMPLE_STRING;
-            const char* string_end = std::strstr(cursor, "\r\n");
-            if (!string_end || string_end > end) {
+            const char* string_end = FindCrlf(cursor, end);
+            if (!string_end) {
                 throw std::runtime_error("Incomplete buffer");
             }
             obj.str_view.len = string_end - cursor;
@@ -71,8 +92,8 @@ RespObject RespParser::ParseNext(const char*& cursor, const char* end) {
     }
         case '-': {
             obj.type = RespType::ERROR;
-            const char* line_end = std::strstr(cursor, "\r\n");
-            if (!line_end || line_end > end)
+            const char* line_end = FindCrlf(cursor, end);
+            if (!line_end)
                 throw std::runtime_error("Incomplete buffer");
 
             obj.str_view.ptr = cursor;
@@ -82,8 +103,8 @@ RespObject RespParser::ParseNext(const char*& cursor, const char* end) {
         }
         case '(': {
             obj.type = RespType::BIG_NUMBER;
-            const char* string_end = std::strstr(cursor, "\r\n");
-            if (!string_end || string_end > end) {
+            const char* string_end = FindCrlf(cursor, end);
+            if (!string_end) {
                 throw std::runtime_error("Incomplete buffer");
             }
             size_t len = string_end - cursor;
@@ -98,6 +119,9 @@ RespObject RespParser::ParseNext(const char*& cursor, const char* end) {
             if (len == -1) {
                 obj.type = RespType::NULL_VAL;
             } else {
+                if (len < 0 || end - cursor < len + 2) {
+                    throw std::runtime_error("Incomplete buffer");
+                }
                 obj.str_view.ptr = cursor;
                 obj.str_view.len = len;
                 cursor += len + 2;
@@ -114,12 +138,15 @@ RespObject RespParser::ParseNext(const char*& cursor, const char* end) {
         }
         case '#': {
             obj.type = RespType::BOOL;
+            if (end - cursor < 3) {
+                throw std::runtime_error("Incomplete buffer");
+            }
             if (*cursor == 't') {
                 obj.int_val = 1;
             } else if (*cursor == 'f') {
                 obj.int_val = 0;
             } else {
-                throw std::runtime_error("Invalid boolean format");
+                throw RespProtocolError("ERROR: invalid boolean in Redis reply");
             }
             cursor += 3;
             break;
@@ -129,7 +156,7 @@ RespObject RespParser::ParseNext(const char*& cursor, const char* end) {
     return obj;
 }
 
-std::vector<RespObject> RespParser::GetObjects() {
+RespTape RespParser::GetObjects() {
     return RespObjects;
 }
 
@@ -143,36 +170,6 @@ void RespParser::SqlToResp(std::string& query) {
     }
 }
 
-std::string RespParser::BuildScan(const std::string& cursor,
-                                  const std::string& pattern) {
-    std::string cmd;
-
-    cmd += "*6\r\n";
-    cmd += "$4\r\nSCAN\r\n";
-    cmd += "$" + std::to_string(cursor.length()) + "\r\n" +
-           cursor + "\r\n";
-
-    cmd += "$5\r\nMATCH\r\n";
-    cmd += "$" + std::to_string(pattern.length()) + "\r\n" +
-           pattern + "\r\n";
-
-    cmd += "$5\r\nCOUNT\r\n";
-    cmd += "$4\r\n2048\r\n";
-
-    return cmd;
-}
-
-std::string RespParser::BuildGet(const std::string& key) {
-    std::string cmd;
-
-    cmd += "*2\r\n";
-    cmd += "$3\r\nGET\r\n";
-    cmd += "$" + std::to_string(key.length()) + "\r\n" +
-           key + "\r\n";
-
-    return cmd;
-}
-
 // testing functions ------------------------------------------------------------------
 
 void RespParser::PrintIndent(int indent) {
@@ -0,0 +1,110 @@
+/*
+  scan_sampler.cpp
+*/
+
+#include "transport/scan_sampler.hpp"
+#include <algorithm>
+#include <charconv>
+#include <cmath>
+#include <random>
+
+// Number of positions in the whole walk (2^64) as a floating point value.
+constexpr long double WALK_POSITIONS = 18446744073709551616.0L;
+
+static uint64_t ReverseBits(uint64_t v) {
+    v = ((v >> 1) & 0x5555555555555555ULL) | ((v & 0x5555555555555555ULL) << 1);
+    v = ((v >> 2) & 0x3333333333333333ULL) | ((v & 0x3333333333333333ULL) << 2);
+    v = ((v >> 4) & 0x0F0F0F0F0F0F0F0FULL) | ((v & 0x0F0F0F0F0F0F0F0FULL) << 4);
+    v = ((v >> 8) & 0x00FF00FF00FF00FFULL) | ((v & 0x00FF00FF00FF00FFULL) << 8);
+    v = ((v >> 16) & 0x0000FFFF0000FFFFULL) | ((v & 0x0000FFFF0000FFFFULL) << 16);
+    return (v >> 32) | (v << 32);
+}
+
+ScanSampler::ScanSampler(double fraction, uint64_t seed, uint64_t key_count)
+    : key_density(static_cast<long double>(key_count) / WALK_POSITIONS) {
+    // Redis sizes its table to a power of two of at least the key count; stay at or below it
+    slice_count = 1;
+    while (slice_count < MAX_SLICES && slice_count * 2 <= key_count) {
+        slice_count <<= 1;
+        slice_bits++;
+    }
+    uint64_t picked = 0;
+    if (fraction > 0) {
+        picked = static_cast<uint64_t>(std::round(std::min(fraction, 1.0) * static_cast<double>(slice_count)));
+    }
+
+    // Partial Fisher-Yates with our own index arithmetic: std::shuffle and the standard
+    // distributions differ between standard libraries, mt19937_64 itself does not.
+    std::vector<uint64_t> order(slice_count);
+    for (uint64_t i = 0; i < slice_count; i++) {
+        order[i] = i;
+    }
+    std::mt19937_64 rng(seed);
+    for (uint64_t i = 0; i < picked; i++) {
+        uint64_t pick = i + rng() % (slice_count - i);
+        std::swap(order[i], order[pick]);
+    }
+    slices.assign(order.begin(), order.begin() + picked);
+    std::sort(slices.begin(), slices.end());
+    Seek();
+}
+
+uint64_t ScanSampler::SliceStart(uint64_t slice) const {
+    return slice_bits == 0 ? 0 : slice << (64 - slice_bits);
+}
+
+uint64_t ScanSampler::SliceEnd(uint64_t slice) const {
+    // the last slice runs until the walk wraps around to cursor 0
+    return slice + 1 == slice_count ? UINT64_MAX : (slice + 1) << (64 - slice_bits);
+}
+
+double ScanSampler::Fraction() const {
+    return static_cast<double>(slices.size()) / static_cast<double>(slice_count);
+}
+
+double ScanSampler::ScannedFraction() const {
+    return static_cast<double>(scanned_positions / WALK_POSITIONS);
+}
+
+void ScanSampler::Seek() {
+    while (current < slices.size() && covered >= SliceEnd(slices[current])) {
+        current++;
+    }
+    if (current == slices.size()) {
+        done = true;
+        return;
+    }
+    call_start = std::max(covered, SliceStart(slices[current]));
+    covered = call_start;
+    cursor = std::to_string(ReverseBits(call_start));
+    SizeCount();
+}
+
+void ScanSampler::SizeCount() {
+    // aim for half of the keys left in the slice, so the last page ends just past the slice
+    long double remaining = static_cast<long double>(SliceEnd(slices[current]) - covered) * key_density;
+    count = static_cast<size_t>(std::clamp<long double>(remaining / 2, 1, MAX_COUNT));
+}
+
+void ScanSampler::Advance(std::string_view returned_cursor) {
+    if (done) {
+        return;
+    }
+    uint64_t next = 0;
+    std::from_chars(returned_cursor.data(), returned_cursor.data() + returned_cursor.size(), next);
+    // cursor 0: the walk wrapped around, everything after the last position has been seen
+    uint64_t reached = next == 0 ? UINT64_MAX : ReverseBits(next);
+    scanned_positions += static_cast<long double>(reached - call_start);
+    if (next == 0) {
+        done = true;
+        return;
+    }
+    covered = reached;
+    call_start = reached;
+    if (covered < SliceEnd(slices[current])) {
+        cursor.assign(returned_cursor.data(), returned_cursor.size());
+        SizeCount();
+        return;
+    }
+    Seek();
+}
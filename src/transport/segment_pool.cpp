@@ -0,0 +1,109 @@
+/*
+  segment_pool.cpp
+*/
+
+#include "transport/segment_pool.hpp"
+#include <algorithm>
+#include <cstring>
+
+SegmentPool& SegmentPool::Instance() {
+    // Never destroyed: segments may still be released by DuckDB vectors during shutdown.
+    static SegmentPool* pool = new SegmentPool();
+    return *pool;
+}
+
+SegmentRef SegmentPool::Acquire(size_t min_capacity) {
+    auto& memory = TransportMemory::Instance();
+    TransportAllocator* allocator = memory.Allocator();
+    char* data = nullptr;
+    size_t capacity = std::max(min_capacity, SEGMENT_SIZE);
+
+    if (capacity == SEGMENT_SIZE) {
+        std::lock_guard<std::mutex> guard(lock);
+        // segments parked under a previous allocator are not reused; Trim() frees them
+        if (!idle.empty() && idle.back().allocator == allocator) {
+            data = idle.back().data;
+            idle.pop_back();
+            memory.Track(MemoryComponent::IDLE_SEGMENTS, -static_cast<int64_t>(SEGMENT_SIZE));
+        }
+    }
+    if (!data) {
+        if (memory.UnderPressure()) {
+            Trim();
+        }
+        data = memory.Allocate(allocator, MemoryComponent::SEGMENTS, capacity);
+    }
+
+    auto* segment = new BufferSegment{data, capacity, 0, allocator};
+    return SegmentRef(segment, [this](BufferSegment* released) { Release(released); });
+}
+
+void SegmentPool::Release(BufferSegment* segment) {
+    auto& memory = TransportMemory::Instance();
+    bool recycled = false;
+    bool pressure = memory.UnderPressure();
+
+    if (segment->capacity == SEGMENT_SIZE && segment->allocator == memory.Allocator() && !pressure) {
+        std::lock_guard<std::mutex> guard(lock);
+        if (idle.size() < max_idle) {
+            idle.push_back({segment->data, segment->allocator});
+            memory.Track(MemoryComponent::IDLE_SEGMENTS, static_cast<int64_t>(SEGMENT_SIZE));
+            recycled = true;
+        }
+    }
+    if (!recycled) {
+        memory.Free(segment->allocator, MemoryComponent::SEGMENTS, segment->data, segment->capacity);
+    }
+    delete segment;
+    // segments parked before the pressure started are the first memory to give back
+    if (pressure) {
+        Trim();
+    }
+}
+
+size_t SegmentPool::IdleCount() {
+    std::lock_guard<std::mutex> guard(lock);
+    return idle.size();
+}
+
+void SegmentPool::Trim() {
+    std::vector<IdleSegment> freed;
+    {
+        std::lock_guard<std::mutex> guard(lock);
+        freed.swap(idle);
+    }
+    auto& memory = TransportMemory::Instance();
+    for (auto& segment : freed) {
+        memory.Track(MemoryComponent::IDLE_SEGMENTS, -static_cast<int64_t>(SEGMENT_SIZE));
+        memory.Free(segment.allocator, MemoryComponent::SEGMENTS, segment.data, SEGMENT_SIZE);
+    }
+}
+
+void SegmentChain::Roll(size_t keep_from, size_t min_space) {
+    size_t pending = tail ? tail->used - keep_from : 0;
+
+    // Doubling for oversized replies keeps the number of re-copies logarithmic.
+    size_t capacity = std::max(SEGMENT_SIZE, std::max(pending * 2, pending + min_space));
+    SegmentRef next = SegmentPool::Instance().Acquire(capacity);
+
+    if (pending > 0) {
+        std::memcpy(next->data, tail->data + keep_from, pending);
+        next->used = pending;
+        // the copied bytes are no longer part of the old segment
+        tail->used = keep_from;
+    }
+
+    tail = next.get();
+    segments.push_back(std::move(next));
+}
+
+void SegmentChain::DropBeforeTail() {
+    if (segments.size() > 1) {
+        segments.erase(segments.begin(), segments.end() - 1);
+    }
+}
+
+void SegmentChain::Clear() {
+    segments.clear();
+    tail = nullptr;
+}
@@ -0,0 +1,72 @@
+/*
+  tls_context.cpp
+*/
+
+#include "transport/tls_context.hpp"
+#include <openssl/err.h>
+#include <openssl/x509v3.h>
+#include <stdexcept>
+
+TlsContext& TlsContext::Instance() {
+    // Never destroyed: pooled connections may still reference the context during shutdown.
+    static TlsContext* context = new TlsContext();
+    return *context;
+}
+
+TlsContext::TlsContext() {
+    ctx = SSL_CTX_new(TLS_client_method());
+    if (!ctx) {
+        throw std::runtime_error("ERROR: could not create TLS context");
+    }
+    SSL_CTX_set_min_proto_version(ctx, TLS1_2_VERSION);
+    SSL_CTX_set_verify(ctx, SSL_VERIFY_PEER, nullptr);
+    SSL_CTX_set_default_verify_paths(ctx);
+#ifdef SSL_OP_ENABLE_KTLS
+    SSL_CTX_set_options(ctx, SSL_OP_ENABLE_KTLS);
+#endif
+    // Sessions are kept per endpoint by us; TLS 1.3 tickets only arrive after the handshake, hence the callback.
+    SSL_CTX_set_session_cache_mode(ctx, SSL_SESS_CACHE_CLIENT | SSL_SESS_CACHE_NO_INTERNAL_STORE);
+    SSL_CTX_sess_set_new_cb(ctx, OnNewSession);
+    key_index = SSL_get_ex_new_index(0, nullptr, nullptr, nullptr, nullptr);
+}
+
+SSL* TlsContext::NewConnection(int fd, const std::string& host, const std::string& session_key) {
+    SSL* ssl = SSL_new(ctx);
+    if (!ssl) {
+        throw std::runtime_error("ERROR: could not create TLS connection");
+    }
+    SSL_set_fd(ssl, fd);
+    SSL_set_ex_data(ssl, key_index, const_cast<std::string*>(&session_key));
+    // IP addresses are matched against the certificate's IP SANs; names get SNI and a host name check
+    if (X509_VERIFY_PARAM_set1_ip_asc(SSL_get0_param(ssl), host.c_str()) != 1) {
+        SSL_set_tlsext_host_name(ssl, host.c_str());
+        SSL_set1_host(ssl, host.c_str());
+    }
+
+    std::lock_guard<std::mutex> guard(lock);
+    auto entry = sessions.find(session_key);
+    if (entry != sessions.end()) {
+        SSL_set_session(ssl, entry->second);
+    }
+    return ssl;
+}
+
+int TlsContext::OnNewSession(SSL* ssl, SSL_SESSION* session) {
+    TlsContext& context = Instance();
+    auto* key = static_cast<const std::string*>(SSL_get_ex_data(ssl, context.key_index));
+    if (!key) {
+        return 0;
+    }
+    context.StoreSession(*key, session);
+    // we keep the reference
+    return 1;
+}
+
+void TlsContext::StoreSession(const std::string& key, SSL_SESSION* session) {
+    std::lock_guard<std::mutex> guard(lock);
+    auto& slot = sessions[key];
+    if (slot) {
+        SSL_SESSION_free(slot);
+    }
+    slot = session;
+}
@@ -0,0 +1,51 @@
+/*
+  transport_memory.cpp
+*/
+
+#include "transport/transport_memory.hpp"
+
+namespace {
+
+class HeapAllocator : public TransportAllocator {
+public:
+    char* Allocate(size_t size) override { return new char[size]; }
+    void Free(char* data, size_t) override { delete[] data; }
+};
+
+} // namespace
+
+TransportMemory& TransportMemory::Instance() {
+    // Never destroyed: segments and tapes may still be released by DuckDB vectors during shutdown.
+    static TransportMemory* memory = new TransportMemory();
+    return *memory;
+}
+
+TransportMemory::TransportMemory() : current(new HeapAllocator()) {}
+
+void TransportMemory::Install(TransportAllocator* allocator) {
+    current.store(allocator, std::memory_order_release);
+}
+
+char* TransportMemory::Allocate(TransportAllocator* allocator, MemoryComponent component, size_t size) {
+    char* data = allocator->Allocate(size);
+    Track(component, static_cast<int64_t>(size));
+    return data;
+}
+
+void TransportMemory::Free(TransportAllocator* allocator, MemoryComponent component, char* data, size_t size) {
+    allocator->Free(data, size);
+    Track(component, -static_cast<int64_t>(size));
+}
+
+void TransportMemory::Track(MemoryComponent component, int64_t delta) {
+    auto index = static_cast<size_t>(component);
+    int64_t now = bytes[index].fetch_add(delta, std::memory_order_relaxed) + delta;
+    int64_t peak = peak_bytes[index].load(std::memory_order_relaxed);
+    while (now > peak && !peak_bytes[index].compare_exchange_weak(peak, now, std::memory_order_relaxed)) {
+    }
+}
+
+MemoryUsage TransportMemory::Usage(MemoryComponent component) const {
+    auto index = static_cast<size_t>(component);
+    return {bytes[index].load(std::memory_order_relaxed), peak_bytes[index].load(std::memory_order_relaxed)};
+}
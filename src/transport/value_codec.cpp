@@ -0,0 +1,221 @@
+/*
+  value_codec.cpp
+*/
+
+#include "transport/value_codec.hpp"
+#include <algorithm>
+#include <limits>
+
+#include <lz4frame.h>
+#include <zstd.h>
+
+namespace {
+
+constexpr uint32_t LZ4_FRAME_MAGIC = 0x184D2204;
+constexpr uint32_t ZSTD_FRAME_MAGIC = 0xFD2FB528;
+// First output size tried for frames without a recorded content size.
+constexpr size_t INITIAL_OUTPUT_SIZE = 64 * 1024;
+
+uint32_t ReadLE32(const char* ptr) {
+    auto bytes = reinterpret_cast<const unsigned char*>(ptr);
+    return uint32_t(bytes[0]) | uint32_t(bytes[1]) << 8 | uint32_t(bytes[2]) << 16 | uint32_t(bytes[3]) << 24;
+}
+
+uint64_t ReadLE64(const char* ptr) {
+    return uint64_t(ReadLE32(ptr)) | uint64_t(ReadLE32(ptr + 4)) << 32;
+}
+
+// One context per codec and thread: creating them costs more than decompressing a small value.
+struct DecompressionContexts {
+    ZSTD_DCtx* zstd = nullptr;
+    LZ4F_dctx* lz4 = nullptr;
+
+    ~DecompressionContexts() {
+        if (zstd) {
+            ZSTD_freeDCtx(zstd);
+        }
+        if (lz4) {
+            LZ4F_freeDecompressionContext(lz4);
+        }
+    }
+
+    ZSTD_DCtx* Zstd() {
+        if (!zstd) {
+            zstd = ZSTD_createDCtx();
+        } else {
+            ZSTD_DCtx_reset(zstd, ZSTD_reset_session_only);
+        }
+        return zstd;
+    }
+
+    LZ4F_dctx* Lz4() {
+        if (!lz4) {
+            if (LZ4F_isError(LZ4F_createDecompressionContext(&lz4, LZ4F_VERSION))) {
+                lz4 = nullptr;
+            }
+        } else {
+            LZ4F_resetDecompressionContext(lz4);
+        }
+        return lz4;
+    }
+};
+
+thread_local DecompressionContexts contexts;
+
+// Next output size for a value without a recorded size; 0 once max_size is reached.
+size_t GrowOutput(size_t capacity, size_t max_size) {
+    if (capacity >= max_size) {
+        return 0;
+    }
+    return std::min(std::max(capacity * 2, INITIAL_OUTPUT_SIZE), max_size);
+}
+
+/*
+  Streams one frame into dest[0, capacity); with 'grow' set the output is
+  enlarged (up to max_size) instead of failing when it runs out of room.
+    - Returns the number of bytes written, or SIZE_MAX on error.
+*/
+size_t Lz4Stream(std::string_view frame, char* dest, size_t capacity, std::string* grow, size_t max_size) {
+    LZ4F_dctx* dctx = contexts.Lz4();
+    if (!dctx) {
+        return SIZE_MAX;
+    }
+    const char* src = frame.data();
+    size_t src_left = frame.size();
+    size_t written = 0;
+
+    for (;;) {
+        if (grow && written == capacity) {
+            size_t next = GrowOutput(capacity, max_size);
+            if (next == 0) {
+                return SIZE_MAX;
+            }
+            grow->resize(next);
+            dest = &(*grow)[0];
+            capacity = grow->size();
+        }
+        size_t dst_size = capacity - written;
+        size_t src_size = src_left;
+        size_t hint = LZ4F_decompress(dctx, dest + written, &dst_size, src, &src_size, nullptr);
+        if (LZ4F_isError(hint)) {
+            return SIZE_MAX;
+        }
+        written += dst_size;
+        src += src_size;
+        src_left -= src_size;
+        if (hint == 0) {
+            return written;
+        }
+        // truncated frame, or more content than the header promised
+        if (dst_size == 0 && src_size == 0) {
+            return SIZE_MAX;
+        }
+    }
+}
+
+size_t ZstdStream(std::string_view frame, std::string& out, size_t max_size) {
+    ZSTD_DCtx* dctx = contexts.Zstd();
+    if (!dctx) {
+        return SIZE_MAX;
+    }
+    ZSTD_inBuffer input = {frame.data(), frame.size(), 0};
+    size_t written = 0;
+    for (;;) {
+        if (written == out.size()) {
+            size_t next = GrowOutput(out.size(), max_size);
+            if (next == 0) {
+                return SIZE_MAX;
+            }
+            out.resize(next);
+        }
+        ZSTD_outBuffer output = {&out[0], out.size(), written};
+        size_t hint = ZSTD_decompressStream(dctx, &output, &input);
+        if (ZSTD_isError(hint)) {
+            return SIZE_MAX;
+        }
+        written = output.pos;
+        if (hint == 0 && input.pos == input.size) {
+            return written;
+        }
+        if (input.pos == input.size && output.pos < output.size) {
+            // input exhausted in the middle of a frame
+            return SIZE_MAX;
+        }
+    }
+}
+
+} // namespace
+
+ValueCompression DetectCompression(std::string_view bytes, ValueCompression allowed) {
+    if (allowed == ValueCompression::NONE || bytes.size() < 4) {
+        return ValueCompression::NONE;
+    }
+    uint32_t magic = ReadLE32(bytes.data());
+    if (magic == LZ4_FRAME_MAGIC && (allowed == ValueCompression::AUTO || allowed == ValueCompression::LZ4)) {
+        return ValueCompression::LZ4;
+    }
+    if (magic == ZSTD_FRAME_MAGIC && (allowed == ValueCompression::AUTO || allowed == ValueCompression::ZSTD)) {
+        return ValueCompression::ZSTD;
+    }
+    return ValueCompression::NONE;
+}
+
+int64_t FrameContentSize(std::string_view frame, ValueCompression codec) {
+    uint64_t size;
+    if (codec == ValueCompression::LZ4) {
+        // magic(4) FLG(1) BD(1) [content size(8)]: bit 3 of FLG says whether the size is present
+        if (frame.size() < 14 || !(static_cast<unsigned char>(frame[4]) & 0x08)) {
+            return -1;
+        }
+        size = ReadLE64(frame.data() + 6);
+    } else if (codec == ValueCompression::ZSTD) {
+        size = ZSTD_getFrameContentSize(frame.data(), frame.size());
+        if (size == ZSTD_CONTENTSIZE_UNKNOWN || size == ZSTD_CONTENTSIZE_ERROR) {
+            return -1;
+        }
+        // several concatenated frames: the first header does not cover the whole value
+        if (ZSTD_findFrameCompressedSize(frame.data(), frame.size()) != frame.size()) {
+            return -1;
+        }
+    } else {
+        return -1;
+    }
+    // a corrupt header must not turn into a huge allocation; DuckDB strings are limited to 4 GB anyway
+    if (size > std::numeric_limits<uint32_t>::max()) {
+        return -1;
+    }
+    return static_cast<int64_t>(size);
+}
+
+bool DecompressFrame(std::string_view frame, ValueCompression codec, char* dest, size_t size) {
+    if (codec == ValueCompression::LZ4) {
+        return Lz4Stream(frame, dest, size, nullptr, size) == size;
+    }
+    if (codec == ValueCompression::ZSTD) {
+        ZSTD_DCtx* dctx = contexts.Zstd();
+        if (!dctx) {
+            return false;
+        }
+        size_t result = ZSTD_decompressDCtx(dctx, dest, size, frame.data(), frame.size());
+        return !ZSTD_isError(result) && result == size;
+    }
+    return false;
+}
+
+bool DecompressFrame(std::string_view frame, ValueCompression codec, std::string& out, size_t max_size) {
+    // a buffer kept from a larger value may already exceed max_size
+    if (out.size() > max_size) {
+        out.resize(max_size);
+    }
+    size_t written = SIZE_MAX;
+    if (codec == ValueCompression::LZ4) {
+        written = Lz4Stream(frame, &out[0], out.size(), &out, max_size);
+    } else if (codec == ValueCompression::ZSTD) {
+        written = ZstdStream(frame, out, max_size);
+    }
+    if (written == SIZE_MAX) {
+        return false;
+    }
+    out.resize(written);
+    return true;
+}
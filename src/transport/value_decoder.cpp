@@ -0,0 +1,276 @@
+/*
+  value_decoder.cpp
+*/
+
+#include "transport/value_decoder.hpp"
+#include <cstring>
+#include <limits>
+
+namespace {
+
+constexpr uint64_t ASCII_ZEROS = 0x3030303030303030ULL;
+
+bool IsLittleEndian() {
+    const uint16_t probe = 1;
+    unsigned char first;
+    std::memcpy(&first, &probe, 1);
+    return first == 1;
+}
+
+// True if all 8 bytes are '0'..'9'.
+bool AllDigits(uint64_t chunk) {
+    return (chunk & 0xF0F0F0F0F0F0F0F0ULL) == ASCII_ZEROS &&
+           ((chunk + 0x0606060606060606ULL) & 0xF0F0F0F0F0F0F0F0ULL) == ASCII_ZEROS;
+}
+
+// Value of 8 ASCII digits loaded little endian (first digit in the lowest byte).
+uint32_t EightDigits(uint64_t chunk) {
+    chunk -= ASCII_ZEROS;
+    chunk = (chunk * 10) + (chunk >> 8);
+    chunk = (((chunk & 0x000000FF000000FFULL) * (100 + (1000000ULL << 32))) +
+             (((chunk >> 16) & 0x000000FF000000FFULL) * (1 + (10000ULL << 32)))) >> 32;
+    return static_cast<uint32_t>(chunk);
+}
+
+// JSON scanner: each function advances pos past one production or returns false.
+class JsonScanner {
+public:
+    explicit JsonScanner(std::string_view text_p) : text(text_p) {}
+
+    bool Document() {
+        SkipWhitespace();
+        if (!Value(0)) {
+            return false;
+        }
+        SkipWhitespace();
+        return pos == text.size();
+    }
+
+private:
+    // Deeper documents are rejected rather than risking the stack.
+    static constexpr int MAX_DEPTH = 512;
+
+    std::string_view text;
+    size_t pos = 0;
+
+    bool AtEnd() const { return pos >= text.size(); }
+    char Peek() const { return text[pos]; }
+
+    void SkipWhitespace() {
+        while (!AtEnd() && (Peek() == ' ' || Peek() == '\t' || Peek() == '\n' || Peek() == '\r')) {
+            pos++;
+        }
+    }
+
+    bool Literal(std::string_view word) {
+        if (text.substr(pos, word.size()) != word) {
+            return false;
+        }
+        pos += word.size();
+        return true;
+    }
+
+    bool Value(int depth) {
+        if (AtEnd() || depth > MAX_DEPTH) {
+            return false;
+        }
+        switch (Peek()) {
+        case '{':
+            return Object(depth + 1);
+        case '[':
+            return Array(depth + 1);
+        case '"':
+            return String();
+        case 't':
+            return Literal("true");
+        case 'f':
+            return Literal("false");
+        case 'n':
+            return Literal("null");
+        default:
+            return Number();
+        }
+    }
+
+    bool Object(int depth) {
+        pos++; // '{'
+        SkipWhitespace();
+        if (!AtEnd() && Peek() == '}') {
+            pos++;
+            return true;
+        }
+        for (;;) {
+            SkipWhitespace();
+            if (AtEnd() || Peek() != '"' || !String()) {
+                return false;
+            }
+            SkipWhitespace();
+            if (AtEnd() || Peek() != ':') {
+                return false;
+            }
+            pos++;
+            SkipWhitespace();
+            if (!Value(depth)) {
+                return false;
+            }
+            SkipWhitespace();
+            if (AtEnd()) {
+                return false;
+            }
+            if (Peek() == '}') {
+                pos++;
+                return true;
+            }
+            if (Peek() != ',') {
+                return false;
+            }
+            pos++;
+        }
+    }
+
+    bool Array(int depth) {
+        pos++; // '['
+        SkipWhitespace();
+        if (!AtEnd() && Peek() == ']') {
+            pos++;
+            return true;
+        }
+        for (;;) {
+            SkipWhitespace();
+            if (!Value(depth)) {
+                return false;
+            }
+            SkipWhitespace();
+            if (AtEnd()) {
+                return false;
+            }
+            if (Peek() == ']') {
+                pos++;
+                return true;
+            }
+            if (Peek() != ',') {
+                return false;
+            }
+            pos++;
+        }
+    }
+
+    static bool IsHex(char c) {
+        return (c >= '0' && c <= '9') || (c >= 'a' && c <= 'f') || (c >= 'A' && c <= 'F');
+    }
+
+    bool String() {
+        pos++; // '"'
+        while (!AtEnd()) {
+            unsigned char c = static_cast<unsigned char>(text[pos++]);
+            if (c == '"') {
+                return true;
+            }
+            if (c < 0x20) {
+                return false;
+            }
+            if (c != '\\') {
+                continue;
+            }
+            if (AtEnd()) {
+                return false;
+            }
+            char escape = text[pos++];
+            if (escape == 'u') {
+                for (int i = 0; i < 4; i++) {
+                    if (AtEnd() || !IsHex(text[pos++])) {
+                        return false;
+                    }
+                }
+            } else if (std::strchr("\"\\/bfnrt", escape) == nullptr || escape == '\0') {
+                return false;
+            }
+        }
+        return false;
+    }
+
+    bool Digits() {
+        size_t start = pos;
+        while (!AtEnd() && Peek() >= '0' && Peek() <= '9') {
+            pos++;
+        }
+        return pos > start;
+    }
+
+    bool Number() {
+        if (!AtEnd() && Peek() == '-') {
+            pos++;
+        }
+        if (AtEnd()) {
+            return false;
+        }
+        if (Peek() == '0') {
+            pos++; // no leading zeros
+        } else if (!Digits()) {
+            return false;
+        }
+        if (!AtEnd() && Peek() == '.') {
+            pos++;
+            if (!Digits()) {
+                return false;
+            }
+        }
+        if (!AtEnd() && (Peek() == 'e' || Peek() == 'E')) {
+            pos++;
+            if (!AtEnd() && (Peek() == '+' || Peek() == '-')) {
+                pos++;
+            }
+            if (!Digits()) {
+                return false;
+            }
+        }
+        return true;
+    }
+};
+
+} // namespace
+
+bool ParseDecimalInt64(std::string_view text, int64_t& out) {
+    const char* ptr = text.data();
+    size_t len = text.size();
+    bool negative = len > 0 && *ptr == '-';
+    if (negative) {
+        ptr++;
+        len--;
+    }
+    // 19 digits always fit into uint64_t; longer numbers are left to the fallback
+    if (len == 0 || len > 19 || (len > 1 && *ptr == '0')) {
+        return false;
+    }
+
+    uint64_t value = 0;
+    if (IsLittleEndian()) {
+        while (len >= 8) {
+            uint64_t chunk;
+            std::memcpy(&chunk, ptr, 8);
+            if (!AllDigits(chunk)) {
+                return false;
+            }
+            value = value * 100000000ULL + EightDigits(chunk);
+            ptr += 8;
+            len -= 8;
+        }
+    }
+    for (; len > 0; ptr++, len--) {
+        if (*ptr < '0' || *ptr > '9') {
+            return false;
+        }
+        value = value * 10 + static_cast<uint64_t>(*ptr - '0');
+    }
+
+    constexpr uint64_t max_positive = static_cast<uint64_t>(std::numeric_limits<int64_t>::max());
+    if (value > max_positive + (negative ? 1 : 0)) {
+        return false;
+    }
+    out = negative ? static_cast<int64_t>(0 - value) : static_cast<int64_t>(value);
+    return true;
+}
+
+bool IsValidJson(std::string_view text) {
+    return JsonScanner(text).Document();
+}